@@ -19,6 +19,7 @@
 #include <bdep/utility.hxx>
 
 #include <bdep/project.hxx>         // find_project()
+#include <bdep/database.hxx>        // lock_wait, lock_command
 #include <bdep/diagnostics.hxx>
 #include <bdep/bdep-options.hxx>
 #include <bdep/project-options.hxx>
@@ -472,6 +473,17 @@ init (const common_options& co,
   //
   verb = verbosity ();
 
+  // Fetch statistics.
+  //
+  fetch_stats.print = o.fetch_stats ();
+
+  // Project database locking.
+  //
+  if (o.lock_wait_specified ())
+    lock_wait = o.lock_wait ();
+
+  lock_command = string ("bdep ") + cmd;
+
   // Temporary directory.
   //
   if (tmp)
@@ -541,6 +553,12 @@ try
   argv0 = argv[0];
   exec_dir = path (argv0).directory ();
 
+  if (getenv ("BDEP_SYNC_JOB"))
+  {
+    sync_job = true;
+    unsetenv ("BDEP_SYNC_JOB");
+  }
+
   // This is a little hack to make our baseutils for Windows work when called
   // with absolute path. In a nutshell, MSYS2's exec*p() doesn't search in the
   // parent's executable directory, only in PATH. And since we are running
@@ -727,6 +745,9 @@ try
   if (r != 0)
     return r;
 
+  if (fetch_stats.print)
+    print_fetch_stats ();
+
   // Warn if args contain some leftover junk. We already successfully
   // performed the command so failing would probably be misleading.
   //
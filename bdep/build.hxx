@@ -11,13 +11,21 @@ namespace bdep
 {
   // Common "build system command" (update, clean, test) implementation.
   //
+  // The build function is expected to start the bpkg command for the
+  // specified configuration, packages, configuration variables, and the
+  // -j option (if any), redirecting its stdout and stderr to the specified
+  // file descriptors.
+  //
   template <typename O>
   int
   cmd_build (const O& o,
-             void (*build) (const O&,
-                            const shared_ptr<configuration>&,
-                            const cstrings&,
-                            const strings&),
+             process (*build) (const O&,
+                               const shared_ptr<configuration>&,
+                               const cstrings& pkgs,
+                               const strings& cfg_vars,
+                               const strings& jobs,
+                               int out,
+                               int err),
              cli::scanner& args);
 }
 
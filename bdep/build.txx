@@ -5,6 +5,7 @@
 
 #include <bdep/project.hxx>
 #include <bdep/database.hxx>
+#include <bdep/project-odb.hxx>
 #include <bdep/diagnostics.hxx>
 
 #include <bdep/sync.hxx>
@@ -14,10 +15,13 @@ namespace bdep
   template <typename O>
   int
   cmd_build (const O& o,
-             void (*build) (const O&,
-                            const shared_ptr<configuration>&,
-                            const cstrings&,
-                            const strings&),
+             process (*build) (const O&,
+                               const shared_ptr<configuration>&,
+                               const cstrings&,
+                               const strings&,
+                               const strings&,
+                               int,
+                               int),
              cli::scanner& args)
   {
     tracer trace ("build");
@@ -53,17 +57,22 @@ namespace bdep
     //
     configurations cfgs;
     {
-      database db (open (prj, o.sqlite_synchronous (), trace));
+      database db (open (prj,
+                         o.sqlite_synchronous (),
+                         trace,
+                         false /* create */,
+                         true  /* shared */));
 
       transaction t (db.begin ());
       pair<configurations, bool> cs (find_configurations (o, prj, t));
-      t.commit ();
 
       // If specified, verify packages are present in at least one
       // configuration.
       //
       if (!pp.packages.empty ())
-        verify_project_packages (pp, cs);
+        verify_project_packages (pp, cs, t);
+
+      t.commit ();
 
       cfgs = move (cs.first);
     }
@@ -72,13 +81,26 @@ namespace bdep
     // been initialized in each configuration. Otherwise, we build only
     // specified packages initialized in the (specified) configurations.
     //
-    const package_locations& pkgs (pp.packages);
-
-    bool all (pkgs.empty ());
+    bool all (pp.packages.empty ());
+    package_name_set pns (pp.package_index ());
 
     // Build in each configuration, skipping those where no packages needs to
     // be built.
     //
+    // If requested, build in multiple configurations in parallel (see
+    // --parallel for details). In this case we first collect the
+    // configurations to build in, pre-sync them all at once, and then run
+    // the builds concurrently, printing the summary at the end. Note that
+    // builds in configurations of the same linked cluster may race updating
+    // the shared (host, build2, etc) configurations, so we only run builds
+    // in configurations that are not linked with each other concurrently.
+    //
+    size_t jobs (o.parallel_specified ()
+                 ? (o.parallel () != 0 ? o.parallel () : cfgs.size ())
+                 : 1);
+
+    vector<pair<shared_ptr<configuration>, cstrings>> bcfgs;
+
     bool first (true);
     for (const shared_ptr<configuration>& c: cfgs)
     {
@@ -88,20 +110,14 @@ namespace bdep
 
       for (const package_state& s: c->packages)
       {
-        if (all ||
-            find_if (pkgs.begin (),
-                     pkgs.end (),
-                     [&s] (const package_location& p)
-                     {
-                       return p.name == s.name;
-                     }) != pkgs.end ())
+        if (all || pns.find (s.name) != pns.end ())
           ps.push_back (s.name.string ().c_str ());
       }
 
       // If we are printing multiple configurations, separate them with a
       // blank line and print the configuration name/directory.
       //
-      if (verb && cfgs.size () > 1)
+      if (verb && cfgs.size () > 1 && jobs == 1)
       {
         text << (first ? "" : "\n")
              << "in configuration " << *c << ':';
@@ -126,12 +142,160 @@ namespace bdep
         continue;
       }
 
+      if (jobs != 1)
+      {
+        bcfgs.emplace_back (c, move (ps));
+        continue;
+      }
+
       // Pre-sync the configuration to avoid triggering the build system hook
       // (see sync for details).
       //
       synced_configs_guard g (cmd_sync (o, prj, c, true /* implicit */));
 
-      build (o, c, ps, cfg_vars);
+      process pr (build (o,
+                         c,
+                         ps,
+                         cfg_vars,
+                         (o.jobs_specified ()
+                          ? strings ({"-j", to_string (o.jobs ())})
+                          : strings ()),
+                         1 /* stdout */,
+                         2 /* stderr */));
+
+      finish_bpkg (o, pr);
+    }
+
+    if (!bcfgs.empty ())
+    {
+      size_t n (bcfgs.size ());
+
+      // Pre-sync all the configurations (see above).
+      //
+      synced_configs_guard g (getenv ("BDEP_SYNCED_CONFIGS"));
+      {
+        configurations cs;
+        for (const auto& bc: bcfgs)
+          cs.push_back (bc.first);
+
+        cmd_sync (o, prj, cs, true /* implicit */);
+      }
+
+      // Split the configurations into consecutive waves of those that are
+      // not linked with each other based on their clusters cached in the
+      // project database (and normally refreshed by the above pre-sync), so
+      // that the output is still printed in the configuration order.
+      //
+      vector<vector<size_t>> ws;
+      {
+        database db (open (prj,
+                           o.sqlite_synchronous (),
+                           trace,
+                           false /* create */,
+                           true  /* shared */));
+
+        transaction t (db.begin ());
+
+        vector<reference_wrapper<const configuration>> cs;
+        for (const auto& bc: bcfgs)
+        {
+          configuration& c (*bc.first);
+
+          if (!c.sync_section.loaded ())
+            db.load (c, c.sync_section);
+
+          cs.push_back (c);
+        }
+
+        t.commit ();
+
+        ws = unlinked_waves (cs, true /* ordered */);
+      }
+
+      {
+        size_t m (0);
+        for (const vector<size_t>& w: ws)
+        {
+          if (w.size () > m)
+            m = w.size ();
+        }
+
+        if (jobs > m)
+          jobs = m;
+      }
+
+      // Split the -j budget (see --jobs for details on its value) between
+      // the concurrent builds.
+      //
+      strings js;
+      {
+        size_t hc (hardware_concurrency ());
+        int32_t j (o.jobs_specified () ? o.jobs () : 0);
+
+        size_t t (j > 0            ? static_cast<size_t> (j)  :
+                  j == 0           ? hc                       :
+                  hc > size_t (-j) ? hc - size_t (-j)         : 1);
+
+        js = strings ({"-j", to_string (t > jobs ? t / jobs : 1)});
+      }
+
+      // The build result in each configuration, absent if not started.
+      //
+      vector<optional<bool>> rs (n);
+
+      auto summary = [n, &bcfgs, &rs] ()
+      {
+        if (verb && n > 1)
+        {
+          diag_record dr (text);
+          dr << '\n';
+
+          for (size_t i (0); i != n; ++i)
+          {
+            if (i != 0)
+              dr << '\n';
+
+            dr << "in configuration " << *bcfgs[i].first << ": "
+               << (rs[i] ? (*rs[i] ? "succeeded" : "failed") : "not started");
+          }
+        }
+      };
+
+      try
+      {
+        for (const vector<size_t>& w: ws)
+        {
+          run_concurrently (
+            jobs,
+            w.size (),
+            [&cfgs, &bcfgs, &w] (size_t i)
+            {
+              if (verb && cfgs.size () > 1)
+                text << (w[i] == 0 ? "" : "\n")
+                     << "in configuration " << *bcfgs[w[i]].first << ':';
+            },
+            [&o, build, &cfg_vars, &bcfgs, &js, &w] (size_t i,
+                                                     int out,
+                                                     int err)
+            {
+              const auto& bc (bcfgs[w[i]]);
+              return build (o, bc.first, bc.second, cfg_vars, js, out, err);
+            },
+            [&o, &rs, &w] (size_t i, process& pr)
+            {
+              rs[w[i]] = false;
+              finish_bpkg (o, pr);
+              rs[w[i]] = true;
+            });
+        }
+      }
+      catch (const failed&)
+      {
+        summary ();
+        throw;
+      }
+
+      summary ();
     }
 
     return 0;
@@ -489,10 +489,23 @@ namespace bdep
             move (n), move (pi.version_string), nullptr, move (pi.src_root)});
       };
 
-      for (package_location& p: pp.packages)
+      // Query the information for all the packages with a single build
+      // system invocation.
+      //
+      dir_paths ds;
+      ds.reserve (pp.packages.size ());
+
+      for (const package_location& p: pp.packages)
+        ds.push_back (pp.project / p.path);
+
+      vector<package_info> pis (
+        package_b_info (o, ds, b_info_flags::committed_version));
+
+      for (size_t i (0); i != pp.packages.size (); ++i)
       {
-        dir_path d (pp.project / p.path);
-        package_info pi (package_b_info (o, d, b_info_flags::committed_version));
+        const package_location& p (pp.packages[i]);
+        const dir_path& d (ds[i]);
+        package_info& pi (pis[i]);
 
         if (pi.src_root == pi.out_root)
           fail << "package " << p.name << " source directory is not forwarded" <<
@@ -507,20 +520,23 @@ namespace bdep
       {
         // Don't keep the database open longer than necessary.
         //
-        database db (open (prj, o.sqlite_synchronous (), trace));
+        database db (open (prj,
+                           o.sqlite_synchronous (),
+                           trace,
+                           false /* create */,
+                           true  /* shared */));
 
         transaction t (db.begin ());
         cfgs = find_configurations (o, prj, t);
+        verify_project_packages (pp, cfgs, t);
         t.commit ();
-
-        verify_project_packages (pp, cfgs);
       }
 
       // Add a package to the list, suppressing duplicates and verifying that
-      // it is initialized in only one configuration.
+      // it is initialized in only one configuration. Note that the package
+      // version and source directory are filled in later (see below).
       //
-      auto add_package = [&o, &pkgs] (package_name n,
-                                      shared_ptr<configuration> c)
+      auto add_package = [&pkgs] (package_name n, shared_ptr<configuration> c)
       {
         auto i (find_if (pkgs.begin (),
                          pkgs.end (),
@@ -537,17 +553,7 @@ namespace bdep
             info << *c;
         }
 
-        package_info pi (package_b_info (o,
-                                         dir_path (c->path) /= n.string (),
-                                         b_info_flags::committed_version));
-
-        verify_package_info (pi, n);
-
-        pkgs.push_back (package {
-            move (n),
-            pi.version.string (),
-            move (c),
-            move (pi.src_root)});
+        pkgs.push_back (package {move (n), string (), move (c), dir_path ()});
       };
 
       if (pp.packages.empty ())
@@ -584,6 +590,29 @@ namespace bdep
           assert (init); // Wouldn't be here otherwise.
         }
       }
+
+      // Query the information for all the packages with a single build
+      // system invocation.
+      //
+      dir_paths ds;
+      ds.reserve (pkgs.size ());
+
+      for (const package& p: pkgs)
+        ds.push_back (dir_path (p.config->path) /= p.name.string ());
+
+      vector<package_info> pis (
+        package_b_info (o, ds, b_info_flags::committed_version));
+
+      for (size_t i (0); i != pkgs.size (); ++i)
+      {
+        package& p (pkgs[i]);
+        package_info& pi (pis[i]);
+
+        verify_package_info (pi, p.name);
+
+        p.version = pi.version.string ();
+        p.src_root = move (pi.src_root);
+      }
     }
 
     // If there are any build package configuration-specific overrides or any
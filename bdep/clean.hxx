@@ -12,23 +12,26 @@
 
 namespace bdep
 {
-  inline void
+  inline process
   cmd_clean (const cmd_clean_options& o,
              const shared_ptr<configuration>& c,
              const cstrings& pkgs,
-             const strings& cfg_vars)
+             const strings& cfg_vars,
+             const strings& jobs,
+             int out,
+             int err)
   {
-    run_bpkg (2,
-              o,
-              "clean",
-              "-d", c->path,
-              (o.immediate () ? "--immediate" :
-               o.recursive () ? "--recursive" : nullptr),
-              (o.jobs_specified ()
-               ? strings ({"-j", to_string (o.jobs ())})
-               : strings ()),
-              cfg_vars,
-              pkgs);
+    return start_bpkg (2,
+                       o,
+                       out,
+                       err,
+                       "clean",
+                       "-d", c->path,
+                       (o.immediate () ? "--immediate" :
+                        o.recursive () ? "--recursive" : nullptr),
+                       jobs,
+                       cfg_vars,
+                       pkgs);
   }
 
   inline int
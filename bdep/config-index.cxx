@@ -0,0 +1,326 @@
+// file      : bdep/config-index.cxx -*- C++ -*-
+// license   : MIT; see accompanying LICENSE file
+
+#include <bdep/config-index.hxx>
+#include <bdep/config-index-odb.hxx>
+
+#include <odb/schema-catalog.hxx>
+
+#include <bdep/database.hxx>
+#include <bdep/diagnostics.hxx>
+
+#include <bdep/sync.hxx> // configuration_repositories()
+
+using namespace std;
+
+namespace bdep
+{
+  using namespace odb::sqlite;
+  using odb::schema_catalog;
+
+  static const string schema_name ("config-index");
+
+  // Open the index database, creating it if it doesn't exist yet. Return
+  // NULL if that's not possible (the index is optional).
+  //
+  // Normally we only verify the schema version, which we do in a deferred
+  // (read) transaction. If the schema needs to be created or migrated, then
+  // we re-open the database (so that the schema version is re-read) in the
+  // upgrade mode and do it in an immediate transaction, switching the
+  // database to the WAL mode (which is persistent) beforehand.
+  //
+  static unique_ptr<database>
+  open_index (const common_options& co, tracer& trace, bool upgrade = false)
+  {
+    path f;
+
+    try
+    {
+      if (co.config_index_specified ())
+        f = co.config_index ();
+      else
+      {
+        dir_path d (dir_path::home_directory () /= ".build2");
+        butl::try_mkdir_p (d);
+
+        f = d / "bdep-config-index.sqlite3";
+      }
+
+      // We don't need the thread pool.
+      //
+      unique_ptr<connection_factory> cf (new single_connection_factory);
+
+      unique_ptr<database> db (
+        new database (f.string (),
+                      SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE,
+                      true,                  // Enable FKs.
+                      "",                    // Default VFS.
+                      move (cf)));
+
+      db->tracer (trace);
+
+      // Unlike the project database, the index is shared by all the bdep
+      // processes of the user and so we keep the NORMAL locking mode, only
+      // lock it for the duration of (short) transactions, and wait for it to
+      // become available if it is locked by another process.
+      //
+      connection_ptr c (db->connection ());
+      c->execute ("PRAGMA busy_timeout = 10000");
+
+      if (upgrade)
+        c->execute ("PRAGMA journal_mode = WAL");
+
+      transaction t (upgrade ? c->begin_immediate () : c->begin ());
+
+      odb::schema_version sv  (db->schema_version (schema_name));
+      odb::schema_version scv (
+        schema_catalog::current_version (*db, schema_name));
+
+      if (sv != scv && !upgrade)
+      {
+        t.rollback ();
+        return open_index (co, trace, true /* upgrade */);
+      }
+
+      if (sv == 0)
+        schema_catalog::create_schema (*db, schema_name);
+      else if (sv != scv)
+      {
+        if (sv < schema_catalog::base_version (*db, schema_name) || sv > scv)
+        {
+          l4 ([&]{trace << "incompatible schema version " << sv << " in "
+                        << f;});
+          return nullptr;
+        }
+
+        schema_catalog::migrate (*db, 0 /* current */, schema_name);
+      }
+
+      t.commit ();
+
+      return db;
+    }
+    catch (const system_error& e)
+    {
+      l4 ([&]{trace << "unable to open configuration index: " << e;});
+    }
+    catch (const odb::exception& e)
+    {
+      l4 ([&]{trace << "unable to open configuration index " << f << ": "
+                    << e.what ();});
+    }
+
+    return nullptr;
+  }
+
+  // Return the bdep projects among the configuration repositories.
+  //
+  static dir_paths
+  scan_projects (const common_options& co, const dir_path& cfg)
+  {
+    dir_paths r;
+    for (dir_path& d: configuration_repositories (co, cfg))
+    {
+      if (exists (d / bdep_file))
+        r.push_back (move (d));
+    }
+    return r;
+  }
+
+  // Return the configuration entry if it exists and NULL otherwise.
+  //
+  static shared_ptr<indexed_configuration>
+  find_config (database& db, const dir_path& cfg)
+  {
+    transaction t (db.begin ());
+    shared_ptr<indexed_configuration> r (
+      db.find<indexed_configuration> (cfg));
+    t.commit ();
+
+    return r;
+  }
+
+  // Update the configuration entry in a write transaction. If the entry
+  // doesn't exist and the (scanned) projects are specified, then create it
+  // with these projects. The function is passed the entry and returns true
+  // if it was modified.
+  //
+  template <typename F>
+  static void
+  update_config (database& db,
+                 const dir_path& cfg,
+                 optional<dir_paths> ps,
+                 const F& f,
+                 tracer& trace)
+  {
+    try
+    {
+      transaction t (db.begin_immediate ());
+
+      shared_ptr<indexed_configuration> c (
+        db.find<indexed_configuration> (cfg));
+
+      if (c == nullptr)
+      {
+        if (ps)
+        {
+          c = make_shared<indexed_configuration> (cfg, move (*ps));
+          f (*c);
+          db.persist (c);
+        }
+      }
+      else if (f (*c))
+        db.update (c);
+
+      t.commit ();
+    }
+    catch (const odb::exception& e)
+    {
+      // If we were unable to update the index, then it may now be stale
+      // which is not something we can silently ignore.
+      //
+      warn << "unable to update configuration index entry for " << cfg
+           << ": " << e.what () <<
+        info << "remove " << db.name () << " to reset the index";
+    }
+  }
+
+  dir_paths
+  config_index_projects (const common_options& co, const dir_path& cfg)
+  {
+    tracer trace ("config_index_projects");
+
+    unique_ptr<database> db (open_index (co, trace));
+
+    if (db != nullptr)
+    {
+      try
+      {
+        if (shared_ptr<indexed_configuration> c = find_config (*db, cfg))
+          return move (c->projects);
+      }
+      catch (const odb::exception& e)
+      {
+        l4 ([&]{trace << "unable to query configuration index: "
+                      << e.what ();});
+      }
+    }
+
+    // Not indexed yet or the index is unusable, so scan the
+    // configuration repositories and index the result, unless it was
+    // indexed by another process in the meantime.
+    //
+    dir_paths r (scan_projects (co, cfg));
+
+    if (db != nullptr)
+      update_config (*db,
+                     cfg,
+                     r,
+                     [] (indexed_configuration&) {return false;},
+                     trace);
+
+    return r;
+  }
+
+  void
+  config_index_add (const common_options& co,
+                    const dir_path& cfg,
+                    const dir_path& prj)
+  {
+    tracer trace ("config_index_add");
+
+    unique_ptr<database> db (open_index (co, trace));
+
+    if (db == nullptr)
+      return;
+
+    // If the configuration is not indexed yet, then scan its repositories
+    // outside of the write transaction.
+    //
+    optional<dir_paths> ps;
+    try
+    {
+      if (find_config (*db, cfg) == nullptr)
+        ps = scan_projects (co, cfg);
+    }
+    catch (const odb::exception& e)
+    {
+      l4 ([&]{trace << "unable to query configuration index: "
+                    << e.what ();});
+    }
+
+    update_config (*db,
+                   cfg,
+                   move (ps),
+                   [&prj] (indexed_configuration& c)
+                   {
+                     dir_paths& v (c.projects);
+
+                     if (find (v.begin (), v.end (), prj) != v.end ())
+                       return false;
+
+                     v.push_back (prj);
+                     return true;
+                   },
+                   trace);
+  }
+
+  void
+  config_index_remove (const common_options& co,
+                       const dir_path& cfg,
+                       const dir_path& prj)
+  {
+    tracer trace ("config_index_remove");
+
+    unique_ptr<database> db (open_index (co, trace));
+
+    if (db == nullptr)
+      return;
+
+    update_config (*db,
+                   cfg,
+                   nullopt /* projects */,
+                   [&prj] (indexed_configuration& c)
+                   {
+                     dir_paths& v (c.projects);
+
+                     auto i (find (v.begin (), v.end (), prj));
+                     if (i == v.end ())
+                       return false;
+
+                     v.erase (i);
+                     return true;
+                   },
+                   trace);
+  }
+
+  void
+  config_index_reset (const common_options& co,
+                      const dir_path& cfg,
+                      bool empty)
+  {
+    tracer trace ("config_index_reset");
+
+    unique_ptr<database> db (open_index (co, trace));
+
+    if (db == nullptr)
+      return;
+
+    dir_paths ps;
+    if (!empty)
+      ps = scan_projects (co, cfg);
+
+    update_config (*db,
+                   cfg,
+                   ps,
+                   [&ps] (indexed_configuration& c)
+                   {
+                     if (c.projects == ps)
+                       return false;
+
+                     c.projects = ps;
+                     return true;
+                   },
+                   trace);
+  }
+}
@@ -0,0 +1,99 @@
+// file      : bdep/config-index.hxx -*- C++ -*-
+// license   : MIT; see accompanying LICENSE file
+
+#ifndef BDEP_CONFIG_INDEX_HXX
+#define BDEP_CONFIG_INDEX_HXX
+
+#include <odb/core.hxx>
+
+#include <bdep/types.hxx>
+#include <bdep/utility.hxx>
+
+#include <bdep/common-options.hxx>
+
+#pragma db model version(1, 1, closed)
+
+namespace bdep
+{
+  #pragma db map type(dir_path) as(string) \
+    to((?).string ()) from(bdep::dir_path (?))
+
+  // User-level configuration index.
+  //
+  // Map bpkg configuration directories to the bdep projects that are using
+  // them (that is, whose repositories are added to the configurations by
+  // init) so that we can find the other projects sharing a configuration
+  // without running bpkg-rep-list and stat'ing every repository directory.
+  //
+  // The index is stored in ~/.build2/bdep-config-index.sqlite3 (unless
+  // overridden with --config-index) and is kept up to date by init, deinit,
+  // and config add/create/move/remove. A configuration which is not indexed
+  // yet (for example, because it was associated with projects by an older
+  // version of bdep or the index was removed) is indexed lazily, based on
+  // its repositories, the first time it is looked up.
+  //
+  // Note that the index is essentially a cache: the users of the returned
+  // projects are expected to verify that they exist and actually know about
+  // the configuration. We, however, don't verify that the index entry still
+  // matches the configuration's repositories (bdep's own bpkg runs change
+  // the configuration database on every synchronization which would make
+  // any such check fail most of the time). As a result, the projects added
+  // to the configuration with bpkg directly won't be noticed until the
+  // configuration is re-associated with a project or the index is removed.
+  // Also note that if the index database is unusable for any reason (the
+  // home directory is not writable, etc), then we silently fall back to
+  // scanning the configuration repositories.
+  //
+  #pragma db object pointer(shared_ptr)
+  class indexed_configuration
+  {
+  public:
+    dir_path  path;     // Absolute and normalized.
+    dir_paths projects; // Absolute and normalized.
+
+    #pragma db member(path) id
+    #pragma db member(projects) value_column("project")
+
+  public:
+    indexed_configuration (dir_path c, dir_paths ps)
+        : path (move (c)), projects (move (ps)) {}
+
+  private:
+    friend class odb::access;
+    indexed_configuration () = default;
+  };
+
+  // Return the list of projects using the configuration, indexing it if
+  // necessary.
+  //
+  dir_paths
+  config_index_projects (const common_options&, const dir_path& cfg);
+
+  // Add the project to the list of projects using the configuration.
+  //
+  void
+  config_index_add (const common_options&,
+                    const dir_path& cfg,
+                    const dir_path& prj);
+
+  // Remove the project from the list of projects using the configuration.
+  // Do nothing if the configuration is not indexed.
+  //
+  void
+  config_index_remove (const common_options&,
+                       const dir_path& cfg,
+                       const dir_path& prj);
+
+  // (Re-)index the configuration, scanning its repositories unless empty is
+  // true in which case assume there are none (for example, because we have
+  // just created it). Used when a configuration is associated with a project
+  // to make sure we don't end up with stale information if a configuration
+  // with the same path previously existed.
+  //
+  void
+  config_index_reset (const common_options&,
+                      const dir_path& cfg,
+                      bool empty = false);
+}
+
+#endif // BDEP_CONFIG_INDEX_HXX
@@ -10,31 +10,39 @@
 #include <bdep/database.hxx>
 #include <bdep/project-odb.hxx>
 #include <bdep/diagnostics.hxx>
+#include <bdep/config-index.hxx>
 
 using namespace std;
 
 namespace bdep
 {
-  template <typename O>
+  template <typename O, typename C>
   static void
-  print_configuration (O& o,
-                       const shared_ptr<configuration>& c,
-                       bool flags = true)
+  print_configuration (O& o, const C& c, bool flags = true)
   {
-    if (c->name)
-      o << '@' << *c->name << ' ';
+    if (c.name)
+      o << '@' << *c.name << ' ';
 
-    o << c->path << ' ' << *c->id << ' ' << c->type;
+    o << c.path << ' ' << *c.id << ' ' << c.type;
 
     if (flags)
     {
       char s (' ');
-      if (c->default_)  {o << s << "default";           s = ',';}
-      if (c->forward)   {o << s << "forwarded";         s = ',';}
-      if (c->auto_sync) {o << s << "auto-synchronized"; s = ',';}
+      if (c.default_)  {o << s << "default";           s = ',';}
+      if (c.forward)   {o << s << "forwarded";         s = ',';}
+      if (c.auto_sync) {o << s << "auto-synchronized"; s = ',';}
     }
   }
 
+  template <typename O>
+  static inline void
+  print_configuration (O& o,
+                       const shared_ptr<configuration>& c,
+                       bool flags = true)
+  {
+    print_configuration (o, *c, flags);
+  }
+
   const char*
   cmd_config_validate_add (const configuration_add_options& o)
   {
@@ -270,6 +278,8 @@ namespace bdep
     //
     vector<pair<dir_path, string>> host_configs;
 
+    bool existing (!type);
+
     if (type)
       ;
     else if (dry_run)
@@ -450,6 +460,14 @@ namespace bdep
 
     t.commit ();
 
+    // If this is an existing configuration, then (re-)index the projects
+    // using it, in case we have stale information about a configuration that
+    // previously existed in this directory (see config-index.hxx for
+    // details).
+    //
+    if (existing)
+      config_index_reset (co, path);
+
     if (verb)
     {
       diag_record dr (text);
@@ -593,6 +611,10 @@ namespace bdep
               "--no-host-config",
               "--no-build2-config",
               args);
+
+    // The newly created configuration has no repositories yet.
+    //
+    config_index_reset (co, path, true /* empty */);
   }
 
   void
@@ -984,10 +1006,11 @@ namespace bdep
     return 0;
   }
 
+  template <typename C>
   static void
-  cmd_config_list_lines (const configurations& cfgs)
+  cmd_config_list_lines (const vector<C>& cfgs)
   {
-    for (const shared_ptr<configuration>& c: cfgs)
+    for (const C& c: cfgs)
     {
       //@@ TODO: use tabular layout facility when ready.
 
@@ -1054,11 +1077,21 @@ namespace bdep
     tracer trace ("config_list");
 
     dir_path prj (find_project (o));
-    database db (open (prj, o.sqlite_synchronous (), trace));
+    database db (open (prj,
+                       o.sqlite_synchronous (),
+                       trace,
+                       false /* create */,
+                       true  /* shared */));
 
     transaction t (db.begin ());
 
+    // Note that in the lines format we don't print the configuration
+    // packages and so, unless the configurations are specified explicitly,
+    // we use the lightweight view that doesn't load them.
+    //
     configurations cfgs;
+    vector<configuration_info> infos;
+
     if (o.config_specified ()    || // Note: handling --all|-a ourselves.
         o.config_id_specified () ||
         o.config_name_specified ())
@@ -1071,18 +1104,34 @@ namespace bdep
     }
     else
     {
-      using query = bdep::query<configuration>;
-
       // We want to show the default configuration first, then sort them
       // by name, and then by path.
       //
-      for (auto c: pointer_result (
-             db.query<configuration> ("ORDER BY" +
-                                      query::default_ + "DESC," +
-                                      query::name     + "IS NULL," +
-                                      query::name     + "," +
-                                      query::path)))
-        cfgs.push_back (move (c));
+      if (o.stdout_format () == stdout_format::lines)
+      {
+        using query = bdep::query<configuration_info>;
+
+        for (configuration_info& c:
+               db.query<configuration_info> (
+                 "ORDER BY" +
+                 query::configuration::default_ + "DESC," +
+                 query::configuration::name     + "IS NULL," +
+                 query::configuration::name     + "," +
+                 query::configuration::path))
+          infos.push_back (move (c));
+      }
+      else
+      {
+        using query = bdep::query<configuration>;
+
+        for (auto c: pointer_result (
+               db.query<configuration> ("ORDER BY" +
+                                        query::default_ + "DESC," +
+                                        query::name     + "IS NULL," +
+                                        query::name     + "," +
+                                        query::path)))
+          cfgs.push_back (move (c));
+      }
     }
 
     t.commit ();
@@ -1091,7 +1140,10 @@ namespace bdep
     {
     case stdout_format::lines:
       {
-        cmd_config_list_lines (cfgs);
+        if (!cfgs.empty ())
+          cmd_config_list_lines (cfgs);
+        else
+          cmd_config_list_lines (infos);
         break;
       }
     case stdout_format::json:
@@ -1177,6 +1229,13 @@ namespace bdep
     db.update (c);
     t.commit ();
 
+    // Update the configuration index (see config-index.hxx for details).
+    //
+    config_index_remove (o, path, prj);
+
+    if (!c->packages.empty ())
+      config_index_add (o, c->path, prj);
+
     if (verb)
     {
       // Restore the original path so that we can use print_configuration().
@@ -1315,6 +1374,14 @@ namespace bdep
 
     t.commit ();
 
+    // Normally, there shouldn't be anything to remove from the configuration
+    // index since there are no initialized packages. But the project could
+    // have been deinitialized with --force, in which case its repository is
+    // left in the configuration.
+    //
+    for (const shared_ptr<configuration>& c: cfgs)
+      config_index_remove (o, c->path, prj);
+
     if (verb)
     {
       for (const shared_ptr<configuration>& c: cfgs)
@@ -3,6 +3,8 @@
 
 #include <bdep/database.hxx>
 
+#include <thread> // this_thread::sleep_for()
+
 #include <odb/schema-catalog.hxx>
 #include <odb/sqlite/exceptions.hxx>
 
@@ -22,21 +24,162 @@ namespace bdep
 
   // Register the data migration functions.
   //
-#if 0
   template <odb::schema_version v>
   using migration_entry = odb::data_migration_entry<v, DB_SCHEMA_VERSION_BASE>;
 
-  static const migration_entry<3>
-  migrate_v3 ([] (odb::database& db)
+  // Invalidate the linked configuration clusters cached without the fetch
+  // cache modes.
+  //
+  static const migration_entry<7>
+  migrate_v7 ([] (odb::database& db)
   {
+    db.execute ("UPDATE configuration SET cluster_stamp = NULL");
   });
-#endif
+
+  optional<duration> lock_wait;
+  string             lock_command;
+
+  // The lock info file, which contains the id and command of the process
+  // that last opened the project database in the exclusive mode (see
+  // --lock-wait for details). Note that the file is only saved the first
+  // time the process opens the database (which is normally done multiple
+  // times per command) and is removed when the process exits. As a result,
+  // it can be stale if the process was terminated (and can also be missing
+  // or belong to another process for a while after the database is locked).
+  // So in diagnostics we only refer to it as the process that last locked
+  // the database.
+  //
+  static inline path
+  lock_info_file (const dir_path& prj)
+  {
+    return prj / bdep_dir / path ("lock-info");
+  }
+
+  // Save the lock info ignoring any errors (it is only used in diagnostics).
+  //
+  // Note that we write it into a temporary file which we then move over the
+  // lock info file so that a process reading it never sees it incomplete.
+  //
+  static void
+  save_lock_info (const dir_path& prj)
+  {
+    path f (lock_info_file (prj));
+    path t (f); t += ".tmp" + to_string (process::current_id ());
+
+    try
+    {
+      auto_rmfile rmt (t);
+
+      ofdstream os (t);
+      os << process::current_id () << ' ' << lock_command << '\n';
+      os.close ();
+
+      butl::mvfile (t, f);
+      rmt.cancel ();
+    }
+    catch (const io_error&) {}
+    catch (const system_error&) {}
+  }
+
+  // Projects whose lock info is saved by this process. On exit remove their
+  // lock info files unless they have been overwritten by another process in
+  // the meantime (which is still racy but the worst that can happen is a
+  // missing or stale lock info).
+  //
+  static struct lock_info_projects: small_vector<dir_path, 1>
+  {
+    ~lock_info_projects ()
+    {
+      string id (to_string (process::current_id ()) + ' ');
+
+      for (const dir_path& d: *this)
+      {
+        path f (lock_info_file (d));
+
+        try
+        {
+          ifdstream is (f);
+
+          string l;
+          getline (is, l);
+          is.close ();
+
+          if (l.compare (0, id.size (), id) == 0)
+            try_rmfile (f, true /* ignore_error */);
+        }
+        catch (const io_error&) {}
+      }
+    }
+  } lock_info_projects_;
+
+  // Return the lock info as "process <id> (<command>)" or nullopt if it is
+  // not available.
+  //
+  static optional<string>
+  load_lock_info (const dir_path& prj)
+  {
+    path f (lock_info_file (prj));
+
+    try
+    {
+      if (exists (f))
+      {
+        ifdstream is (f);
+
+        string l;
+        getline (is, l);
+        is.close ();
+
+        size_t p (l.find (' '));
+        if (p != string::npos && p != 0)
+          return "process " + string (l, 0, p) + " (" + string (l, p + 1) + ')';
+      }
+    }
+    catch (const io_error&) {}
+
+    return nullopt;
+  }
+
+  // Print the duration in seconds with the millisecond precision.
+  //
+  static string
+  to_seconds (duration d)
+  {
+    using namespace std::chrono;
+
+    if (d < duration::zero ()) // System clock adjustment.
+      d = duration::zero ();
+
+    uint64_t ms (duration_cast<milliseconds> (d).count ());
+
+    string r (to_string (ms / 1000));
+
+    if (ms % 1000 != 0)
+    {
+      string f (to_string (ms % 1000));
+      r += '.';
+      r.append (3 - f.size (), '0');
+      r += f;
+
+      while (r.back () == '0')
+        r.pop_back ();
+    }
+
+    r += (ms == 1000 ? " second" : " seconds");
+    return r;
+  }
 
   database
-  open (const dir_path& d, sqlite_synchronous sync, tracer& tr, bool create)
+  open (const dir_path& d,
+        sqlite_synchronous sync,
+        tracer& tr,
+        bool create,
+        bool shared)
   {
     tracer trace ("open");
 
+    assert (!create || !shared);
+
     path f (d / bdep_file);
 
     if (exists (f))
@@ -45,6 +188,8 @@ namespace bdep
       fail << d << " does not look like an initialized project directory" <<
         info << "run 'bdep init' to initialize";
 
+    bool reopen (false); // Re-open in the exclusive mode for migration.
+
     try
     {
       // We don't need the thread pool.
@@ -67,10 +212,31 @@ namespace bdep
       // the database is inaccessible (e.g., file does not exist, already used
       // by another process, etc).
       //
+      // In the shared mode we keep the NORMAL locking mode and start a
+      // deferred transaction that only acquires the (WAL) read lock. This
+      // will still fail if the database is locked by a process that opened
+      // it in the exclusive mode.
+      //
+      // If --lock-wait is specified and the database is locked by another
+      // process, then we retry with the bounded backoff until the database
+      // becomes available or the wait time expires. Note that SQLite locks
+      // provide no queueing and so the waiting processes are not guaranteed
+      // to acquire the database in the order they started waiting. Keeping
+      // the retry interval short, however, prevents the late arrivals from
+      // being systematically favored over the long-waiting processes.
+      //
+      using std::chrono::milliseconds;
+
+      timestamp start (timestamp_nonexistent); // Wait start.
+      milliseconds retry (50);
+
+      for (;;)
       try
       {
         connection_ptr c (db.connection ());
-        c->execute ("PRAGMA locking_mode = EXCLUSIVE");
+
+        if (!shared)
+          c->execute ("PRAGMA locking_mode = EXCLUSIVE");
 
         // Use the WAL (Write-Ahead Logging) journaling mode and, by default,
         // the NORMAL synchronization mode to speed up the transaction
@@ -93,7 +259,7 @@ namespace bdep
         c->execute ("PRAGMA journal_mode = WAL");
         c->execute ("PRAGMA main.synchronous = " + to_string (sync));
 
-        transaction t (c->begin_exclusive ());
+        transaction t (!shared ? c->begin_exclusive () : c->begin ());
 
         if (create)
         {
@@ -154,23 +320,94 @@ namespace bdep
             if (sv > scv)
               fail << "project " << d << " is too new";
 
+            // Migration requires the exclusive access so re-open the
+            // database in the exclusive mode (which will be accessible once
+            // we close this connection, releasing the read lock; see below).
+            //
+            if (shared)
+            {
+              t.rollback ();
+              reopen = true;
+              break;
+            }
+
             schema_catalog::migrate (db);
           }
         }
 
         t.commit ();
+
+        if (!shared &&
+            find (lock_info_projects_.begin (),
+                  lock_info_projects_.end (),
+                  d) == lock_info_projects_.end ())
+        {
+          save_lock_info (d);
+          lock_info_projects_.push_back (d);
+        }
+
+        if (start != timestamp_nonexistent && verb)
+          info << "waited "
+               << to_seconds (std::chrono::system_clock::now () - start)
+               << " for project " << d;
+
+        break;
       }
       catch (odb::timeout&)
       {
-        fail << "project " << d << " is already used by another process";
+        timestamp now (std::chrono::system_clock::now ());
+
+        bool first (start == timestamp_nonexistent);
+
+        if (first)
+          start = now;
+
+        optional<string> li (load_lock_info (d));
+
+        if (!lock_wait || now - start >= *lock_wait)
+        {
+          diag_record dr;
+          dr << fail << "project " << d << " is already used by another "
+             << "process";
+
+          if (li)
+            dr << info << "last locked by " << *li;
+
+          if (lock_wait)
+            dr << info << "waited " << to_seconds (now - start);
+        }
+
+        if (first && verb)
+        {
+          diag_record dr (info);
+          dr << "project " << d << " is used by another process";
+
+          if (li)
+            dr << " (last locked by " << *li << ')';
+
+          dr << ", waiting up to " << to_seconds (*lock_wait);
+        }
+
+        std::this_thread::sleep_for (retry);
+
+        retry = min (retry * 2, milliseconds (500));
       }
 
-      db.tracer (tr); // Switch to the caller's tracer.
-      return db;
+      if (!reopen)
+      {
+        db.tracer (tr); // Switch to the caller's tracer.
+        return db;
+      }
     }
     catch (const database_exception& e)
     {
       fail << f << ": " << e.message () << endf;
     }
+
+    // Note that the shared connection is closed at this point since the
+    // database instance (and its connection factory) has been destroyed.
+    //
+    assert (reopen);
+    return open (d, sync, tr, false /* create */, false /* shared */);
   }
 }
@@ -23,11 +23,33 @@ namespace bdep
   using odb::result;
   using odb::session;
 
+  // The maximum time to wait for the project database to become available if
+  // it is locked by another process (see --lock-wait for details) and the
+  // command to record in the lock info as the database lock holder. Set by
+  // main().
+  //
+  extern optional<duration> lock_wait;
+  extern string             lock_command;
+
+  // Open the project database, creating it if requested.
+  //
+  // By default, the database is locked for as long as it is open, which
+  // prevents its concurrent use by other bdep processes. If shared is true,
+  // then open it for reading only without locking it beyond the read
+  // transactions so that multiple read-only commands can use the project
+  // concurrently. Note that in this mode the caller should not modify the
+  // database and should not keep it open longer than necessary. Note also
+  // that such readers still cannot use the project while it is open by
+  // another process in the exclusive mode (for example, for the duration of
+  // a synchronization) and fail or wait for it as if they were writers (see
+  // --lock-wait for details).
+  //
   database
   open (const dir_path& project,
         sqlite_synchronous,
         tracer&,
-        bool create = false);
+        bool create = false,
+        bool shared = false);
 
   struct tracer_guard
   {
@@ -11,6 +11,7 @@
 #include <bdep/sync.hxx>
 #include <bdep/fetch.hxx>
 #include <bdep/config.hxx>
+#include <bdep/config-index.hxx>
 
 using namespace std;
 
@@ -52,6 +53,7 @@ namespace bdep
     if (c->forward)
     {
       package_locations pls (load_packages (prj));
+      vector<pair<dir_path, dir_path>> fwds;
 
       for (const string& n: pkgs)
       {
@@ -71,14 +73,10 @@ namespace bdep
           src /= i->path;
         }
 
-        // See sync for details on --no-external-modules.
-        //
-        run_b (o,
-               "--no-external-modules",
-               "disfigure:",
-               '\'' + src.representation () + "'@'" + out.representation () +
-               "',forward");
+        fwds.emplace_back (move (src), move (out));
       }
+
+      run_b_forward (o, "disfigure", fwds);
     }
 
     // Try to drop the packages watching out for their potential dependents.
@@ -166,13 +164,14 @@ namespace bdep
                              t,
                              true   /* fallback_default */,
                              !force /* validate */));
-      t.commit ();
 
       // If specified, verify packages are present in at least one
       // configuration.
       //
       if (!pp.packages.empty ())
-        verify_project_packages (pp, cs);
+        verify_project_packages (pp, cs, t);
+
+      t.commit ();
 
       cfgs = move (cs.first);
 
@@ -311,11 +310,15 @@ namespace bdep
       // packages that are initialized in it.
       //
       if (!force && c->packages.empty ())
+      {
         run_bpkg (3,
                   o,
                   "remove",
                   "-d", c->path,
                   repository_name (prj));
+
+        config_index_remove (o, c->path, prj);
+      }
     }
 
     return 0;
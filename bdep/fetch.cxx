@@ -3,18 +3,253 @@
 
 #include <bdep/fetch.hxx>
 
+#include <bdep/git.hxx>
+#include <bdep/sync.hxx>      // sync_checksum()
 #include <bdep/database.hxx>
 #include <bdep/diagnostics.hxx>
+#include <bdep/project-odb.hxx>
 
 using namespace std;
 
 namespace bdep
 {
+  string
+  fetch_stamp (const common_options& o, const dir_path& prj)
+  {
+    if (!o.fetch_max_age_specified ())
+      return string ();
+
+    paths ps {prj / repositories_file, prj / packages_file};
+
+    for (path& p: git_state_files (prj))
+      ps.push_back (move (p));
+
+    for (const package_location& pl: load_packages (prj))
+      ps.push_back (prj / pl.path / manifest_file);
+
+    return sync_checksum (strings (), ps);
+  }
+
   void
-  cmd_fetch (const common_options& o,
-             const dir_path& prj,
-             const shared_ptr<configuration>& c,
-             bool full)
+  load_fetch_info (const common_options& o,
+                   database& db,
+                   const configurations& cfgs)
+  {
+    if (!o.fetch_max_age_specified ())
+      return;
+
+    for (const shared_ptr<configuration>& c: cfgs)
+    {
+      if (!c->fetch_section.loaded ())
+        db.load (*c, c->fetch_section);
+    }
+  }
+
+  bool
+  fetch_fresh (const common_options& o,
+               const configuration& c,
+               fetch_depth d,
+               const string& stamp)
+  {
+    using std::chrono::nanoseconds;
+    using std::chrono::duration_cast;
+
+    if (!o.fetch_max_age_specified ())
+      return false;
+
+    assert (c.fetch_section.loaded ());
+
+    if (!c.fetch_time                                        ||
+        !c.fetch_depth                                       ||
+        *c.fetch_depth < static_cast<uint64_t> (d)           ||
+        !c.fetch_stamp                                       ||
+        *c.fetch_stamp != stamp)
+      return false;
+
+    timestamp t (
+      duration_cast<duration> (nanoseconds (
+                                 static_cast<nanoseconds::rep> (
+                                   *c.fetch_time))));
+
+    // Note that the system clock could have been adjusted backwards.
+    //
+    timestamp now (std::chrono::system_clock::now ());
+    return t <= now && now - t <= o.fetch_max_age ();
+  }
+
+  // Project repositories fetched during this invocation.
+  //
+  struct fetched_repository
+  {
+    dir_path    config;
+    dir_path    project;
+    fetch_depth depth;
+  };
+
+  static vector<fetched_repository> fetched_repositories;
+
+  fetch_statistics fetch_stats;
+
+  optional<fetch_skip_reason>
+  fetch_skip (const common_options& o,
+              const dir_path& prj,
+              const configuration& c,
+              fetch_depth d,
+              const string& stamp)
+  {
+    ++fetch_stats.requested;
+
+    // Note that the full fetch covers all the configuration repositories.
+    //
+    if (find_if (fetched_repositories.begin (),
+                 fetched_repositories.end (),
+                 [&prj, &c, d] (const fetched_repository& r)
+                 {
+                   return r.config == c.path &&
+                          r.depth >= d       &&
+                          (r.depth == fetch_depth::full || r.project == prj);
+                 }) != fetched_repositories.end ())
+    {
+      ++fetch_stats.repeated;
+      return fetch_skip_reason::repeated;
+    }
+
+    if (fetch_fresh (o, c, d, stamp))
+    {
+      ++fetch_stats.recent;
+      return fetch_skip_reason::recent;
+    }
+
+    return nullopt;
+  }
+
+  void
+  fetch_performed (const dir_path& prj, const configuration& c, fetch_depth d)
+  {
+    ++fetch_stats.performed;
+    fetched_repositories.push_back (fetched_repository {c.path, prj, d});
+  }
+
+  pair<vector<size_t>, size_t>
+  fetch_waves (const common_options& o, const vector<strings>& reps)
+  {
+    size_t n (reps.size ());
+
+    vector<size_t> r;
+    r.reserve (n);
+
+    // Note that we don't check whether the fetch cache is disabled in the
+    // configurations themselves in which case we will just fetch in waves
+    // needlessly.
+    //
+    optional<string> fc (getenv ("BPKG_FETCH_CACHE"));
+
+    if (o.no_fetch_cache () || (fc && *fc == "0"))
+    {
+      for (size_t i (0); i != n; ++i)
+        r.push_back (i);
+
+      return make_pair (move (r), n);
+    }
+
+    strings      rs;     // Repositories fetched in the first wave.
+    vector<bool> fw (n); // True if the fetch is in the first wave.
+
+    for (size_t i (0); i != n; ++i)
+    {
+      for (const string& rep: reps[i])
+      {
+        if (find (rs.begin (), rs.end (), rep) == rs.end ())
+        {
+          rs.push_back (rep);
+          fw[i] = true;
+        }
+      }
+
+      if (fw[i])
+        r.push_back (i);
+    }
+
+    size_t k (r.size ());
+
+    for (size_t i (0); i != n; ++i)
+    {
+      if (!fw[i])
+        r.push_back (i);
+    }
+
+    fetch_stats.reused += n - k;
+
+    return make_pair (move (r), k);
+  }
+
+  void
+  print_fetch_stats ()
+  {
+    const fetch_statistics& s (fetch_stats);
+
+    text << "repository fetches: " << s.requested << " requested, "
+         << s.performed << " performed, "
+         << s.repeated << " skipped as repeated, "
+         << s.recent << " skipped as recent, "
+         << s.reused << " delayed to reuse fetch cache";
+  }
+
+  void
+  save_fetch_info (const common_options& o,
+                   database& db,
+                   configuration& c,
+                   fetch_depth d,
+                   const string& stamp,
+                   timestamp start)
+  {
+    using std::chrono::nanoseconds;
+    using std::chrono::duration_cast;
+
+    if (!o.fetch_max_age_specified ())
+      return;
+
+    if (!c.fetch_section.loaded ())
+      db.load (c, c.fetch_section);
+
+    c.fetch_time = static_cast<uint64_t> (
+      duration_cast<nanoseconds> (start.time_since_epoch ()).count ());
+    c.fetch_depth = static_cast<uint64_t> (d);
+    c.fetch_stamp = stamp;
+
+    db.update (c, c.fetch_section);
+  }
+
+  void
+  save_fetch_info (const common_options& o,
+                   const dir_path& prj,
+                   const configurations& cfgs,
+                   fetch_depth d,
+                   const string& stamp,
+                   timestamp start)
+  {
+    tracer trace ("save_fetch_info");
+
+    if (!o.fetch_max_age_specified () || cfgs.empty ())
+      return;
+
+    database db (open (prj, o.sqlite_synchronous (), trace));
+
+    transaction t (db.begin ());
+
+    for (const shared_ptr<configuration>& c: cfgs)
+      save_fetch_info (o, db, *c, d, stamp, start);
+
+    t.commit ();
+  }
+
+  process
+  start_fetch (const common_options& o,
+               const dir_path& prj,
+               const shared_ptr<configuration>& c,
+               bool full,
+               int out,
+               int err)
   {
     // Let's use the repository name rather than the location as a sanity
     // check (the repository must have been added as part of init).
@@ -22,13 +257,72 @@ namespace bdep
     // Let's not pass --no-dir-progress in the full mode so that we can see
     // the whole picture (see the call from deinit, in particular).
     //
-    run_bpkg (2,
-              o,
-              "fetch",
-              "-d", c->path,
-              (!full
-               ? cstrings ({"--no-dir-progress", repository_name (prj).c_str ()})
-               : cstrings ()));
+    return start_bpkg (2,
+                       o,
+                       out,
+                       err,
+                       "fetch",
+                       "-d", c->path,
+                       (!full
+                        ? strings ({"--no-dir-progress", repository_name (prj)})
+                        : strings ()));
+  }
+
+  void
+  cmd_fetch (const common_options& o,
+             const dir_path& prj,
+             const shared_ptr<configuration>& c,
+             bool full)
+  {
+    tracer trace ("fetch");
+
+    fetch_depth d (full ? fetch_depth::full : fetch_depth::deep);
+    string stamp (fetch_stamp (o, prj));
+    timestamp start (std::chrono::system_clock::now ());
+
+    // If we are called within a transaction (deinit), then it is on the
+    // project database which we therefore reuse.
+    //
+    auto db_op = [&o, &prj, &trace] (const function<void (database&)>& f)
+    {
+      if (transaction::has_current ())
+      {
+        f (transaction::current ().database ());
+      }
+      else
+      {
+        database db (open (prj, o.sqlite_synchronous (), trace));
+
+        transaction t (db.begin ());
+        f (db);
+        t.commit ();
+      }
+    };
+
+    if (o.fetch_max_age_specified ())
+      db_op ([&o, &c] (database& db) {load_fetch_info (o, db, {c});});
+
+    if (optional<fetch_skip_reason> r = fetch_skip (o, prj, *c, d, stamp))
+    {
+      if (verb)
+        info << "skipping " << (*r == fetch_skip_reason::repeated
+                                ? "already"
+                                : "recently") << " fetched configuration "
+             << *c;
+
+      return;
+    }
+
+    process pr (start_fetch (o, prj, c, full, 1 /* stdout */, 2 /* stderr */));
+    finish_bpkg (o, pr);
+
+    fetch_performed (prj, *c, d);
+
+    if (o.fetch_max_age_specified ())
+      db_op ([&o, &c, d, &stamp, start] (database& db)
+             {
+               save_fetch_info (o, db, *c, d, stamp, start);
+             });
   }
 
   int
@@ -42,13 +336,24 @@ namespace bdep
     {
       // Don't keep the database open longer than necessary.
       //
-      database db (open (prj, o.sqlite_synchronous (), trace));
+      database db (open (prj,
+                         o.sqlite_synchronous (),
+                         trace,
+                         false /* create */,
+                         true  /* shared */));
 
       transaction t (db.begin ());
       cfgs = find_configurations (o, prj, t).first;
+      load_fetch_info (o, db, cfgs);
       t.commit ();
     }
 
+    fetch_depth d (o.full () ? fetch_depth::full : fetch_depth::deep);
+    string stamp (fetch_stamp (o, prj));
+    timestamp start (std::chrono::system_clock::now ());
+
+    configurations fcfgs; // Fetched configurations.
+
     bool first (true);
     for (const shared_ptr<configuration>& c: cfgs)
     {
@@ -69,9 +374,26 @@ namespace bdep
         first = false;
       }
 
-      cmd_fetch (o, prj, c, o.full ());
+      if (optional<fetch_skip_reason> r = fetch_skip (o, prj, *c, d, stamp))
+      {
+        if (verb)
+          info << "skipping " << (*r == fetch_skip_reason::repeated
+                                  ? "already"
+                                  : "recently") << " fetched configuration "
+               << *c;
+
+        continue;
+      }
+
+      process pr (
+        start_fetch (o, prj, c, o.full (), 1 /* stdout */, 2 /* stderr */));
+      finish_bpkg (o, pr);
+
+      fetch_performed (prj, *c, d);
+      fcfgs.push_back (c);
     }
 
+    save_fetch_info (o, prj, fcfgs, d, stamp, start);
     return 0;
   }
 }
@@ -12,12 +12,160 @@
 
 namespace bdep
 {
+  // Fetch freshness.
+  //
+  // After a successful fetch of the project repository in a configuration we
+  // save in the project database (see configuration::fetch_section) the fetch
+  // start time and depth as well as the project repository stamp, that is,
+  // the checksum of the modification times of the filesystem entries that
+  // determine the repository contents (package and repository manifests, git
+  // HEAD and index). If --fetch-max-age is specified, then a fetch is skipped
+  // if an at least as deep fetch was performed no longer than that ago and
+  // the stamp still matches.
+  //
+  // Note that only the project repository stamp is verified with any
+  // changes to its prerequisite/complement repositories only picked up
+  // after the fetch information expires. Also note that the fetch
+  // information is only saved (and the stamp is only calculated) if
+  // --fetch-max-age is specified, so that there is no extra project
+  // database access otherwise.
+  //
+  enum class fetch_depth: uint16_t
+  {
+    shallow, // Project repository (bpkg-rep-fetch --shallow).
+    deep,    // Project repository and its prerequisites and complements.
+    full     // All the configuration repositories.
+  };
+
+  // Return the project repository stamp or empty string if --fetch-max-age
+  // is not specified.
+  //
+  string
+  fetch_stamp (const common_options&, const dir_path& prj);
+
+  // Load the fetch information of the specified configurations if
+  // --fetch-max-age is specified. Must be called within a transaction on the
+  // project database.
+  //
+  void
+  load_fetch_info (const common_options&, database&, const configurations&);
+
+  // Return true if the fetch of the specified depth can be skipped in the
+  // configuration. The fetch information is expected to be loaded if
+  // --fetch-max-age is specified.
+  //
+  bool
+  fetch_fresh (const common_options&,
+               const configuration&,
+               fetch_depth,
+               const string& stamp);
+
+  // Save the information about the successful fetch started at the
+  // specified time if --fetch-max-age is specified. The first version must
+  // be called within a transaction on the project database while the second
+  // opens it.
+  //
+  void
+  save_fetch_info (const common_options&,
+                   database&,
+                   configuration&,
+                   fetch_depth,
+                   const string& stamp,
+                   timestamp start);
+
+  void
+  save_fetch_info (const common_options&,
+                   const dir_path& prj,
+                   const configurations&,
+                   fetch_depth,
+                   const string& stamp,
+                   timestamp start);
+
+  // Fetch deduplication.
+  //
+  // During the bdep invocation we keep track of the project repositories
+  // fetched in each configuration and skip repeated (at most as deep)
+  // fetches of the same repository in the same configuration (for example,
+  // a shallow fetch of the project repository during synchronization after
+  // the full fetch during deinit). Also, when fetching the same repositories
+  // deep in multiple configurations concurrently, we first fetch each
+  // distinct repository set in a single configuration so that the rest of
+  // the configurations can reuse the prerequisite and complement
+  // repositories from the bpkg fetch cache rather than fetching them
+  // concurrently (see fetch_waves() for details).
+  //
+  // Return the reason if the project repository fetch of the specified depth
+  // can be skipped in the configuration, that is, because it has already
+  // been performed during this invocation or because it is fresh (see
+  // above), and nullopt otherwise. Account for the fetch in the statistics.
+  //
+  enum class fetch_skip_reason
+  {
+    repeated,
+    recent
+  };
+
+  optional<fetch_skip_reason>
+  fetch_skip (const common_options&,
+              const dir_path& prj,
+              const configuration&,
+              fetch_depth,
+              const string& stamp);
+
+  // Note the successful project repository fetch in the configuration.
+  //
+  void
+  fetch_performed (const dir_path& prj, const configuration&, fetch_depth);
+
+  // Given the lists of repositories to deep-fetch in multiple configurations
+  // concurrently, return the order in which to fetch them and the number of
+  // fetches in the first wave, that is, fetches that should complete before
+  // the rest are started. The first wave contains the fetches which are the
+  // first to fetch some repository. If the bpkg fetch cache is disabled,
+  // then all the fetches are in the first wave.
+  //
+  pair<vector<size_t>, size_t>
+  fetch_waves (const common_options&, const vector<strings>& reps);
+
+  // Fetch statistics (see --fetch-stats for details).
+  //
+  struct fetch_statistics
+  {
+    size_t requested = 0; // Repository fetches requested.
+    size_t performed = 0; // Repository fetches performed.
+    size_t repeated  = 0; // Skipped as already performed in this invocation.
+    size_t recent    = 0; // Skipped as fresh (see --fetch-max-age).
+    size_t reused    = 0; // Delayed to reuse the fetch cache (see above).
+
+    bool print = false;   // Print on successful command completion.
+  };
+
+  extern fetch_statistics fetch_stats;
+
+  void
+  print_fetch_stats ();
+
+  // Fetch the project repository in the configuration, unless it can be
+  // skipped (see above). Note that this function may be called within a
+  // transaction on the project database.
+  //
   void
   cmd_fetch (const common_options&,
              const dir_path& prj,
              const shared_ptr<configuration>&,
              bool full);
 
+  // As above but only start the bpkg-fetch process, redirecting its stdout
+  // and stderr to the specified file descriptors.
+  //
+  process
+  start_fetch (const common_options&,
+               const dir_path& prj,
+               const shared_ptr<configuration>&,
+               bool full,
+               int out,
+               int err);
+
   int
   cmd_fetch (const cmd_fetch_options&, cli::scanner& args);
 }
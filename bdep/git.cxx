@@ -487,4 +487,28 @@ namespace bdep
 
     return r;
   }
+
+  paths
+  git_state_files (const dir_path& prj)
+  {
+    paths r;
+
+    for (dir_path d (prj); !d.empty (); d = d.directory ())
+    {
+      if (git_repository (d))
+      {
+        dir_path gd (d / dir_path (".git"));
+
+        if (exists (gd))
+        {
+          r.push_back (gd / path ("HEAD"));
+          r.push_back (gd / path ("index"));
+        }
+
+        break;
+      }
+    }
+
+    return r;
+  }
 }
@@ -200,6 +200,15 @@ namespace bdep
   git_repository_status
   git_status (const dir_path& repo);
 
+  // Return the paths of the HEAD and index files of the git repository the
+  // project belongs to (not necessarily at its root), if any. Their
+  // modification times can be used to detect the repository state changes
+  // without running git. Note that the submodule/worktree case (where .git
+  // is a file) is not handled and an empty list is returned.
+  //
+  paths
+  git_state_files (const dir_path& prj);
+
   // Run the git push command.
   //
   template <typename... A>
@@ -3,6 +3,8 @@
 
 #include <bdep/init.hxx>
 
+#include <map>
+
 #include <bdep/project.hxx>
 #include <bdep/project-odb.hxx>
 #include <bdep/database.hxx>
@@ -10,6 +12,7 @@
 
 #include <bdep/sync.hxx>
 #include <bdep/config.hxx>
+#include <bdep/config-index.hxx>
 
 using namespace std;
 
@@ -23,6 +26,7 @@ namespace bdep
     if (!exists (sd))
     {
       mk (sd);
+      clear_project_package_cache ();
 
       // Create the .gitignore file that ignores everything under .bdep/
       // effectively making git ignore it (this prevents people from
@@ -87,6 +91,18 @@ namespace bdep
                            move (id));
   }
 
+  // Default or forwarded configuration a package is initialized in (see
+  // cmd_init() below for details). The configuration object is only present
+  // if we are initializing in this configuration.
+  //
+  struct package_config // VC14 doesn't like it inside the function.
+  {
+    uint64_t                  id;
+    bool                      default_;
+    bool                      forward;
+    shared_ptr<configuration> config;
+  };
+
   void
   cmd_init (const common_options& o,
             const dir_path& prj,
@@ -116,21 +132,89 @@ namespace bdep
     // initialized in multiple default or forwarded configurations and fail if
     // that's not the case.
     //
-    // Note that we perform verification in a separate loop to make sure that
+    // Note that we perform verification in a separate pass to make sure that
     // no actual bpkg commands are executed and no database changes are
     // committed by the time of potential failure.
     //
+    // Rather than querying the database for every configuration/package
+    // pair, load the default and forwarded configurations the packages are
+    // already initialized in with a single query and then simulate the
+    // initialization in memory.
+    //
+    if (find_if (cfgs.begin (),
+                 cfgs.end (),
+                 [] (const shared_ptr<configuration>& c)
+                 {
+                   return c->default_ || c->forward;
+                 }) != cfgs.end ())
     {
-      transaction t (db.begin ());
+      map<package_name, vector<package_config>> pcs;
 
-      // For the sake of simplicity, add packages to the configuration
-      // objects, updating their state in the database (so that the changes
-      // are seen by the queries) and rollback the transaction in the
-      // end. Note that by doing so, we can end up modifying passed
-      // configuration objects and then failing, which is probably ok.
+      // For the configurations we are initializing in, use the passed
+      // configuration objects.
       //
+      auto initializing = [&cfgs] (uint64_t id)
+      {
+        return find_if (cfgs.begin (),
+                        cfgs.end (),
+                        [id] (const shared_ptr<configuration>& c)
+                        {
+                          return *c->id == id;
+                        }) != cfgs.end ();
+      };
+
       for (const shared_ptr<configuration>& c: cfgs)
       {
+        if (c->default_ || c->forward)
+        {
+          for (const package_location& p: pkgs)
+          {
+            if (initialized (p, c))
+              pcs[p.name].push_back (
+                package_config {*c->id, c->default_, c->forward, c});
+          }
+        }
+      }
+
+      // For the rest, query the database.
+      //
+      if (!pkgs.empty ())
+      {
+        using query = bdep::query<package_configuration>;
+
+        query q ("cp.name IN (");
+        for (auto b (pkgs.begin ()), i (b); i != pkgs.end (); ++i)
+        {
+          if (i != b)
+            q += ",";
+
+          q += query::_ref (i->name);
+        }
+        q += ")";
+
+        q = q && (query::configuration::default_ ||
+                  query::configuration::forward);
+
+        transaction t (db.begin ());
+
+        for (package_configuration& pc: db.query<package_configuration> (q))
+        {
+          if (!initializing (pc.id))
+            pcs[move (pc.name)].push_back (
+              package_config {pc.id, pc.default_, pc.forward, nullptr});
+        }
+
+        t.commit ();
+      }
+
+      for (const shared_ptr<configuration>& c: cfgs)
+      {
+        // Nothing to verify if this configuration is neither default nor
+        // forwarded.
+        //
+        if (!c->default_ && !c->forward)
+          continue;
+
         for (const package_location& p: pkgs)
         {
           // Skip the package if it is already initialized in this
@@ -139,46 +223,51 @@ namespace bdep
           if (initialized (p, c))
             continue;
 
+          vector<package_config>& v (pcs[p.name]);
+
           // Verify that there is no other default or forwarded configuration
           // that also has this package.
           //
-          using query = bdep::query<configuration>;
-
-          auto verify = [&c, &p, &db, &initialized] (const query& q,
-                                                     const char* what)
+          auto verify = [&c, &p, &db, &v] (bool package_config::*f,
+                                           const char* what)
           {
-            for (const shared_ptr<configuration>& o:
-                   pointer_result (db.query<configuration> (q)))
+            auto i (find_if (v.begin (),
+                             v.end (),
+                             [f] (const package_config& pc) {return pc.*f;}));
+
+            if (i != v.end ())
             {
-              if (initialized (p, o))
+              // Differ, since the package is not initialized in `c` (see
+              // above).
+              //
+              assert (i->id != *c->id);
+
+              shared_ptr<configuration> o (i->config);
+
+              if (o == nullptr)
               {
-                // Differ, since the package is not initialized in `c` (see
-                // above).
-                //
-                assert (o->id != c->id);
-
-                fail << what << " configuration " << *o << " also has package "
-                     << p.name << " initialized" <<
-                  info << "while initializing in " << what << " configuration "
-                     << *c <<
-                  info << "specify packages and configurations explicitly";
+                transaction t (db.begin ());
+                o = db.load<configuration> (i->id);
+                t.commit ();
               }
+
+              fail << what << " configuration " << *o << " also has package "
+                   << p.name << " initialized" <<
+                info << "while initializing in " << what << " configuration "
+                   << *c <<
+                info << "specify packages and configurations explicitly";
             }
           };
 
           if (c->default_)
-            verify (query::default_, "default");
+            verify (&package_config::default_, "default");
 
           if (c->forward)
-            verify (query::forward, "forwarded");
+            verify (&package_config::forward, "forwarded");
 
-          c->packages.push_back (package_state {p.name});
+          v.push_back (package_config {*c->id, c->default_, c->forward, c});
         }
-
-        db.update (c);
       }
-
-      t.rollback ();
     }
 
     // Now, execute the actual bpkg commands and update configurations for
@@ -211,18 +300,14 @@ namespace bdep
                 "--type", "dir",
                 prj);
 
+      config_index_add (o, c->path, prj);
+
       vector<pair<dir_path, string>> created_cfgs;
 
       try
       {
         transaction t (db.begin ());
 
-        // Reload the configuration object that could have been changed during
-        // verification. This is required for skipping the already initialized
-        // packages.
-        //
-        db.reload (*c);
-
         bool first (c->packages.empty ()); // First init for this project.
 
         for (const package_location& p: pkgs)
@@ -4083,6 +4083,11 @@ cmd_new (cmd_new_options&& o, cli::group_scanner& args)
       dr << (pkg ? "package " : "project ") << n << " in " << out;
   }
 
+  // We have created the project/package root markers (manifests, etc) so
+  // the cached lookups may no longer be accurate.
+  //
+  clear_project_package_cache ();
+
   // --no-init | --package | --source
   //
   if (o.no_init () || pkg || src)
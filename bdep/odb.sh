@@ -53,6 +53,15 @@ $odb "${inc[@]}"                                                      \
     --include-with-brackets --include-prefix bdep --guard-prefix BDEP \
     --sqlite-override-null project.hxx
 
+$odb "${inc[@]}"                                                      \
+    -DLIBODB_BUILD2 -DLIBODB_SQLITE_BUILD2 --generate-schema          \
+    --schema-name config-index                                        \
+    -d sqlite --std c++14 --generate-query                            \
+    --odb-epilogue '#include <bdep/wrapper-traits.hxx>'               \
+    --hxx-prologue '#include <bdep/wrapper-traits.hxx>'               \
+    --include-with-brackets --include-prefix bdep --guard-prefix BDEP \
+    --sqlite-override-null config-index.hxx
+
 $odb "${inc[@]}"                                                      \
     -DLIBODB_BUILD2 -DLIBODB_SQLITE_BUILD2                            \
     -d sqlite --std c++14 --generate-query                            \
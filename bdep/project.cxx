@@ -4,6 +4,14 @@
 #include <bdep/project.hxx>
 #include <bdep/project-odb.hxx>
 
+#include <map>
+#include <set>
+#include <atomic>
+#include <thread>
+#include <exception> // exception_ptr
+
+#include <libbutl/process.hxx>
+#include <libbutl/filesystem.hxx>
 #include <libbutl/manifest-parser.hxx>
 
 #include <libbpkg/manifest.hxx>
@@ -62,6 +70,54 @@ namespace bdep
       auto ii (is.begin ());
       auto ie (is.end ());
 
+      // Load all the mentioned configurations with a single query,
+      // regardless of the number of options specified. Then add them in the
+      // order the options were specified, failing for the first one that
+      // does not exist.
+      //
+      configurations cs;
+      dir_paths dns; // Normalized configuration directories.
+
+      if (ni != ne || di != de || ii != ie)
+      {
+        strings nvs;
+        for (const pair<string, size_t>& n: ns)
+          nvs.push_back (n.first);
+
+        strings dvs;
+        for (const pair<dir_path, size_t>& d: ds)
+        {
+          dns.push_back (normalize (d.first, "configuration directory"));
+          dvs.push_back (dns.back ().string ());
+        }
+
+        vector<uint64_t> ivs;
+        for (const pair<uint64_t, size_t>& i: is)
+          ivs.push_back (i.first);
+
+        query q (false);
+
+        if (!nvs.empty ())
+          q = q || query::name.in_range (nvs.begin (), nvs.end ());
+
+        if (!dvs.empty ())
+          q = q || query::path.in_range (dvs.begin (), dvs.end ());
+
+        if (!ivs.empty ())
+          q = q || query::id.in_range (ivs.begin (), ivs.end ());
+
+        for (auto c: pointer_result (db.query<configuration> (q)))
+          cs.push_back (move (c));
+      }
+
+      auto lookup = [&cs] (const auto& pred) -> shared_ptr<configuration>
+      {
+        auto i (find_if (cs.begin (), cs.end (), pred));
+        return i != cs.end () ? *i : nullptr;
+      };
+
+      auto dni (dns.begin ());
+
       // Return true if the first options range is not empty and position of
       // its leftmost option is less than positions in two other option
       // ranges.
@@ -79,7 +135,10 @@ namespace bdep
         {
           const string& n (ni->first);
 
-          if (auto c = db.query_one<configuration> (query::name == n))
+          if (auto c = lookup ([&n] (const shared_ptr<configuration>& e)
+                               {
+                                 return e->name && *e->name == n;
+                               }))
             add (move (c));
           else
             fail << "no configuration name '" << n << "' in project " << prj;
@@ -88,24 +147,28 @@ namespace bdep
         }
         else if (lt (di, de, ii, ie, ni, ne))
         {
-          dir_path d (di->first);
-
-          normalize (d, "configuration directory");
+          const dir_path& d (*dni);
 
-          if (auto c = db.query_one<configuration> (query::path ==
-                                                    d.string ()))
+          if (auto c = lookup ([&d] (const shared_ptr<configuration>& e)
+                               {
+                                 return e->path == d;
+                               }))
             add (move (c));
           else
             fail << "no configuration directory " << d << " in project "
                  << prj;
 
           ++di;
+          ++dni;
         }
         else if (lt (ii, ie, ni, ne, di, de))
         {
           uint64_t id (ii->first);
 
-          if (auto c = db.find<configuration> (id))
+          if (auto c = lookup ([id] (const shared_ptr<configuration>& e)
+                               {
+                                 return *e->id == id;
+                               }))
             add (move (c));
           else
             fail << "no configuration id " << id << " in project " << prj;
@@ -174,6 +237,18 @@ namespace bdep
     return make_pair (move (r), fallback);
   }
 
+  // The find_project_package() results cached for the duration of the
+  // process since the same directories are normally looked up several times
+  // by a command (see clear_project_package_cache() for details).
+  //
+  static map<pair<dir_path, bool>, project_package> project_package_cache;
+
+  void
+  clear_project_package_cache ()
+  {
+    project_package_cache.clear ();
+  }
+
   project_package
   find_project_package (const dir_path& start,
                         bool allow_subdir,
@@ -183,11 +258,25 @@ namespace bdep
     optional<dir_path> pkg;
 
     dir_path d (normalize (start, "project directory"));
+
+    pair<dir_path, bool> k (d, allow_subdir);
+    {
+      auto i (project_package_cache.find (k));
+      if (i != project_package_cache.end ())
+        return i->second;
+    }
+
     for (; !d.empty (); d = d.directory ())
     {
       // Ignore errors when checking for file existence since we may be
       // iterating over directories past any reasonable project boundaries.
       //
+      // Note that we probe for each marker separately rather than reading
+      // the directory since a project root can contain a large number of
+      // entries (packages, etc) and reading it on a slow (for example,
+      // network) filesystem may well be more expensive than a few stat()
+      // calls.
+      //
       bool p (exists (d / manifest_file, true));
       if (p)
       {
@@ -249,7 +338,9 @@ namespace bdep
     else if (pkg)
       pkg = pkg->leaf (prj);
 
-    return project_package {move (prj), move (pkg)};
+    project_package r {move (prj), move (pkg)};
+    project_package_cache.emplace (move (k), r);
+    return r;
   }
 
   static package_locations
@@ -297,19 +388,227 @@ namespace bdep
     return pls;
   }
 
+  // Package manifest summary cache.
+  //
+  // To avoid parsing every package manifest on each command, for initialized
+  // projects we cache the package names and projects in .bdep/manifests
+  // along with the manifest file sizes and modification times they are
+  // valid for. The file contains a line per package in the following form:
+  //
+  // <size> <mtime> <name> <project> <dir>
+  //
+  // Where <project> is `-` if not specified and <dir> is the package
+  // directory relative to the project root (empty for a simple project).
+  //
+  // Note that a manifest can be modified without changing its size and
+  // modification time if this happens within the filesystem timestamp
+  // granularity after we have read it. So, similar to git's racy index
+  // entries, we ignore the summaries for manifests whose modification time
+  // is not older than that of the cache file (and which thus could have
+  // been modified after the cache was written).
+  //
+  // Also note that the cache is purely an optimization and so we ignore
+  // any errors reading or writing it.
+  //
+  struct manifest_summary
+  {
+    uint64_t               size;
+    timestamp              mtime;
+    package_name           name;
+    optional<package_name> project;
+  };
+
+  using manifest_summaries = map<dir_path, manifest_summary>;
+
+  static inline path
+  manifests_file (const dir_path& prj)
+  {
+    return prj / bdep_dir / path ("manifests");
+  }
+
+  static manifest_summaries
+  load_manifest_summaries (const dir_path& prj)
+  {
+    manifest_summaries r;
+
+    path f (manifests_file (prj));
+
+    try
+    {
+      timestamp ft (file_mtime (f));
+
+      if (ft == timestamp_nonexistent)
+        return r;
+
+      ifdstream is (f);
+
+      for (string l; !eof (getline (is, l)); )
+      {
+        // Split the line into the four space-separated fields and the rest.
+        //
+        strings fs;
+        size_t b (0);
+        for (size_t e; fs.size () != 4; b = e + 1)
+        {
+          if ((e = l.find (' ', b)) == string::npos)
+            return manifest_summaries ();
+
+          fs.emplace_back (l, b, e - b);
+        }
+
+        manifest_summary s {
+          stoull (fs[0]),
+          timestamp (duration (stoll (fs[1]))),
+          package_name (move (fs[2])),
+          fs[3] != "-" ? package_name (move (fs[3])) : optional<package_name> ()};
+
+        if (s.mtime < ft) // Not racy (see above)?
+          r.emplace (dir_path (string (l, b)), move (s));
+      }
+
+      is.close ();
+    }
+    // Note: stoull() and stoll() throw logic_error-derived exceptions as do
+    // the package_name and dir_path constructors.
+    //
+    catch (const logic_error&)  {r.clear ();}
+    catch (const io_error&)     {r.clear ();}
+    catch (const system_error&) {r.clear ();}
+
+    return r;
+  }
+
+  static void
+  save_manifest_summaries (const dir_path& prj, const manifest_summaries& ss)
+  {
+    path f (manifests_file (prj));
+    path t (f); t += ".tmp" + to_string (process::current_id ());
+
+    try
+    {
+      auto_rmfile rmt (t);
+
+      ofdstream os (t);
+
+      for (const auto& p: ss)
+      {
+        const manifest_summary& s (p.second);
+
+        os << s.size << ' '
+           << s.mtime.time_since_epoch ().count () << ' '
+           << s.name << ' '
+           << (s.project ? s.project->string () : string ("-")) << ' '
+           << p.first.string () << '\n';
+      }
+
+      os.close ();
+
+      butl::mvfile (t, f);
+      rmt.cancel ();
+    }
+    catch (const io_error&) {}
+    catch (const system_error&) {}
+  }
+
+  // The result of loading a package manifest (see load_package_names() for
+  // details).
+  //
+  // VC14 doesn't like it inside the function.
+  //
+  struct manifest_load
+  {
+    bool                   exists = true;
+    uint64_t               size;
+    timestamp              mtime;
+    bool                   cached = false;
+
+    package_name           name;
+    optional<package_name> project;
+
+    exception_ptr          stat_error;
+    exception_ptr          parse_error;
+  };
+
   static void
   load_package_names (const dir_path& prj, package_locations& pls)
   {
-    // Load each package's manifest and obtain its name and project (they are
-    // normally at the beginning of the manifest so we could optimize this, if
-    // necessary).
+    tracer trace ("load_package_names");
+
+    // Only cache the manifest summaries for initialized projects.
     //
-    for (package_location& pl: pls)
+    bool cache (exists (prj / bdep_dir, true /* ignore_error */));
+
+    manifest_summaries ss;
+    if (cache)
+      ss = load_manifest_summaries (prj);
+
+    size_t n (pls.size ());
+    vector<manifest_load> ls (n);
+
+    // First stat each package's manifest and see if its summary is cached.
+    //
+    // Note that here and below we don't issue any diagnostics but rather
+    // save the errors and then report the first one in the package order
+    // (see below) so that the result is the same as if the manifests were
+    // loaded sequentially.
+    //
+    vector<size_t> ps; // Packages whose manifests need parsing.
+
+    for (size_t i (0); i != n; ++i)
     {
+      const package_location& pl (pls[i]);
+      manifest_load& l (ls[i]);
+
       path f (prj / pl.path / manifest_file);
 
-      if (!exists (f))
-        fail << "package manifest file " << f << " does not exist";
+      try
+      {
+        pair<bool, butl::entry_stat> pe (
+          butl::path_entry (f, true /* follow_symlinks */));
+
+        if (!pe.first)
+        {
+          l.exists = false;
+          continue;
+        }
+
+        l.size = pe.second.size;
+        l.mtime = file_mtime (f);
+      }
+      catch (const system_error&)
+      {
+        l.stat_error = current_exception ();
+        continue;
+      }
+
+      if (cache)
+      {
+        auto j (ss.find (pl.path));
+
+        if (j != ss.end () &&
+            j->second.size == l.size &&
+            j->second.mtime == l.mtime)
+        {
+          l.cached = true;
+          continue;
+        }
+      }
+
+      ps.push_back (i);
+    }
+
+    // Load the remaining manifests and obtain the package names and projects
+    // (they are normally at the beginning of the manifest so we could
+    // optimize this, if necessary).
+    //
+    // With many packages this can take a while so if there are several of
+    // them, we parse them in parallel using a pool of worker threads, each
+    // picking the next package to parse from the shared list.
+    //
+    auto parse = [&prj, &pls, &ls] (size_t i)
+    {
+      manifest_load& l (ls[i]);
+      path f (prj / pls[i].path / manifest_file);
 
       try
       {
@@ -320,19 +619,119 @@ namespace bdep
                                   false /* ignore_unknown */,
                                   false /* complete_depends */);
 
-        pl.name = move (m.name);
-        pl.project = move (m.project);
+        l.name = move (m.name);
+        l.project = move (m.project);
+      }
+      catch (...)
+      {
+        l.parse_error = current_exception ();
+      }
+    };
+
+    if (size_t jobs = min (ps.size (), hardware_concurrency ()))
+    {
+      atomic<size_t> next (0);
+
+      auto work = [&ps, &parse, &next] ()
+      {
+        for (size_t i; (i = next++) < ps.size (); )
+          parse (ps[i]);
+      };
+
+      // Note that we also do the work in this thread and that failing to
+      // start a worker thread is not fatal: we just end up with fewer of
+      // them.
+      //
+      vector<thread> ts;
+      ts.reserve (jobs - 1);
+
+      try
+      {
+        while (ts.size () != jobs - 1)
+          ts.emplace_back (work);
+      }
+      catch (const system_error& e)
+      {
+        l4 ([&]{trace << "unable to start worker thread: " << e;});
+      }
+
+      work ();
+
+      for (thread& t: ts)
+        t.join ();
+    }
+
+    // Now report the errors and merge the results, in the package order.
+    //
+    // Note that we also drop the summaries for packages that are no longer
+    // in the project.
+    //
+    manifest_summaries nss;
+    bool changed (false);
+
+    for (size_t i (0); i != n; ++i)
+    {
+      package_location& pl (pls[i]);
+      manifest_load& l (ls[i]);
+
+      path f (prj / pl.path / manifest_file);
+
+      if (!l.exists)
+        fail << "package manifest file " << f << " does not exist";
+
+      if (l.stat_error != nullptr)
+      {
+        try
+        {
+          rethrow_exception (l.stat_error);
+        }
+        catch (const system_error& e)
+        {
+          fail << "unable to stat " << f << ": " << e;
+        }
       }
-      catch (const manifest_parsing& e)
+
+      if (l.cached)
       {
-        fail << "invalid package manifest: " << f << ':'
-             << e.line << ':' << e.column << ": " << e.description << endf;
+        auto j (ss.find (pl.path));
+
+        pl.name = j->second.name;
+        pl.project = j->second.project;
+
+        nss.emplace (pl.path, move (j->second));
+        continue;
       }
-      catch (const io_error& e)
+
+      if (l.parse_error != nullptr)
+      {
+        try
+        {
+          rethrow_exception (l.parse_error);
+        }
+        catch (const manifest_parsing& e)
+        {
+          fail << "invalid package manifest: " << f << ':'
+               << e.line << ':' << e.column << ": " << e.description;
+        }
+        catch (const io_error& e)
+        {
+          fail << "unable to read " << f << ": " << e;
+        }
+      }
+
+      pl.name = move (l.name);
+      pl.project = move (l.project);
+
+      if (cache)
       {
-        fail << "unable to read " << f << ": " << e << endf;
+        nss.emplace (pl.path,
+                     manifest_summary {l.size, l.mtime, pl.name, pl.project});
+        changed = true;
       }
     }
+
+    if (cache && (changed || nss.size () != ss.size ()))
+      save_manifest_summaries (prj, nss);
   }
 
   package_locations
@@ -504,41 +903,88 @@ namespace bdep
     return make_pair (project_packages {move (prj), move (rpls)}, move (rps));
   }
 
+  // Fail with the package not initialized diagnostics.
+  //
+  static void
+  fail_uninitialized (const package_name& n,
+                      const pair<configurations, bool>& cfgs)
+  {
+    diag_record dr (fail);
+
+    dr << "package " << n << " is not initialized in ";
+
+    if (cfgs.second)
+      dr << "any default configuration(s)";
+    else if (cfgs.first.size () == 1)
+      dr << "configuration " << *cfgs.first.front ();
+    else
+      dr << "any specified configurations";
+  }
+
   void
   verify_project_packages (const project_packages& pp,
                            const pair<configurations, bool>& cfgs)
   {
+    vector<package_name_set> cps;
+    cps.reserve (cfgs.first.size ());
+
+    for (const shared_ptr<configuration>& c: cfgs.first)
+      cps.push_back (c->package_index ());
+
     for (const package_location& p: pp.packages)
     {
-      bool init (false);
+      if (none_of (cps.begin (), cps.end (),
+                   [&p] (const package_name_set& s)
+                   {
+                     return s.find (p.name) != s.end ();
+                   }))
+        fail_uninitialized (p.name, cfgs);
+    }
+  }
 
-      for (const shared_ptr<configuration>& c: cfgs.first)
-      {
-        if (find_if (c->packages.begin (),
-                     c->packages.end (),
-                     [&p] (const package_state& s)
-                     {
-                       return p.name == s.name;
-                     }) != c->packages.end ())
-        {
-          init = true;
-          break;
-        }
-      }
+  void
+  verify_project_packages (const project_packages& pp,
+                           const pair<configurations, bool>& cfgs,
+                           transaction& t)
+  {
+    if (pp.packages.empty ())
+      return;
 
-      if (!init)
-      {
-        diag_record dr (fail);
+    if (cfgs.first.empty ())
+      fail_uninitialized (pp.packages.front ().name, cfgs);
 
-        dr << "package " << p.name << " is not initialized in ";
+    database& db (t.database ());
+    using query = bdep::query<package_configuration>;
 
-        if (cfgs.second)
-          dr << "any default configuration(s)";
-        else if (cfgs.first.size () == 1)
-          dr << "configuration " << *cfgs.first.front ();
-        else
-          dr << "any specified configurations";
-      }
+    // Query the names of the specified packages initialized in any of the
+    // specified configurations.
+    //
+    vector<uint64_t> ids;
+    ids.reserve (cfgs.first.size ());
+
+    for (const shared_ptr<configuration>& c: cfgs.first)
+      ids.push_back (*c->id);
+
+    query q ("cp.name IN (");
+    for (auto b (pp.packages.begin ()), i (b); i != pp.packages.end (); ++i)
+    {
+      if (i != b)
+        q += ",";
+
+      q += query::_ref (i->name);
+    }
+    q += ")";
+
+    q = q && query::configuration::id.in_range (ids.begin (), ids.end ());
+
+    set<package_name> init;
+    for (package_configuration& pc: db.query<package_configuration> (q))
+      init.insert (move (pc.name));
+
+    for (const package_location& p: pp.packages)
+    {
+      if (init.find (p.name) == init.end ())
+        fail_uninitialized (p.name, cfgs);
     }
   }
 
@@ -569,6 +1015,70 @@ namespace bdep
     }
   }
 
+  vector<package_info>
+  package_b_info (const common_options& o,
+                  const dir_paths& ds,
+                  b_info_flags fl)
+  {
+    vector<package_info> r;
+
+    if (ds.empty ())
+      return r;
+
+    try
+    {
+      b_info (r,
+              ds,
+              fl,
+              verb,
+              [] (const char* const args[], size_t n)
+              {
+                if (verb >= 3)
+                  print_process (args, n);
+              },
+              path (name_b (o)),
+              exec_dir,
+              o.build_option ());
+    }
+    catch (const b_error& e)
+    {
+      if (e.normal ())
+        throw failed (); // Assume the build2 process issued diagnostics.
+
+      diag_record dr (fail);
+      dr << "unable to obtain project info for package directories: " << e;
+
+      for (const dir_path& d: ds)
+        dr << info << "package directory " << d;
+    }
+
+    assert (r.size () == ds.size ());
+    return r;
+  }
+
+  vector<standard_version>
+  package_versions (const common_options& o, const dir_paths& ds)
+  {
+    vector<package_info> pis (package_b_info (o, ds, b_info_flags::none));
+
+    vector<standard_version> r;
+    r.reserve (pis.size ());
+
+    for (size_t i (0); i != pis.size (); ++i)
+    {
+      package_info& pi (pis[i]);
+
+      if (pi.version.empty ())
+        fail << "package in directory " << ds[i] << " does not use standard "
+             << "version" <<
+          info << "perhaps the package does not load the version module?";
+
+      r.push_back (move (pi.version));
+    }
+
+    return r;
+  }
+
   standard_version
   package_version (const common_options& o, const dir_path& d)
   {
@@ -611,21 +1121,98 @@ namespace bdep
         info << "perhaps the package does not load the version module?";
   }
 
+  bool
+  configurations_linked (const configuration& x, const configuration& y)
+  {
+    assert (x.sync_section.loaded () && y.sync_section.loaded ());
+
+    if (x.cluster.empty () || y.cluster.empty ())
+      return true;
+
+    auto member = [] (const configuration& c, const dir_path& d)
+    {
+      return find_if (c.cluster.begin (), c.cluster.end (),
+                      [&d] (const cluster_config& cc)
+                      {
+                        return cc.path == d;
+                      }) != c.cluster.end ();
+    };
+
+    return member (x, y.path) || member (y, x.path);
+  }
+
+  vector<vector<size_t>>
+  unlinked_waves (const vector<reference_wrapper<const configuration>>& cs,
+                  bool ordered)
+  {
+    vector<vector<size_t>> r;
+
+    for (size_t i (0); i != cs.size (); ++i)
+    {
+      const configuration& c (cs[i]);
+
+      // Add the configuration to the first wave (only consider the last one
+      // if ordered) that has no configurations linked with it, creating a
+      // new wave if there is none.
+      //
+      auto w (find_if (ordered && !r.empty () ? r.end () - 1 : r.begin (),
+                       r.end (),
+                       [&cs, &c] (const vector<size_t>& w)
+                       {
+                         for (size_t j: w)
+                         {
+                           if (configurations_linked (c, cs[j]))
+                             return false;
+                         }
+
+                         return true;
+                       }));
+
+      if (w == r.end ())
+        w = r.insert (r.end (), vector<size_t> ());
+
+      w->push_back (i);
+    }
+
+    return r;
+  }
+
   // project_packages
   //
   void project_packages::
   append (package_locations&& pls)
   {
+    // Note that we use the (ordered) set for paths since their comparison
+    // is platform-specific.
+    //
+    set<dir_path> ps;
+    for (const package_location& l: packages)
+      ps.insert (l.path);
+
     for (package_location& l: pls)
     {
-      if (find_if (packages.begin (), packages.end (),
-                   [&l] (const package_location& pl)
-                   {
-                     return pl.path == l.path;
-                   }) == packages.end ())
-      {
+      if (ps.insert (l.path).second)
         packages.push_back (move (l));
-      }
     }
   }
+
+  package_name_set project_packages::
+  package_index () const
+  {
+    package_name_set r (packages.size ());
+    for (const package_location& l: packages)
+      r.insert (l.name);
+    return r;
+  }
+
+  // configuration
+  //
+  package_name_set configuration::
+  package_index () const
+  {
+    package_name_set r (packages.size ());
+    for (const package_state& s: packages)
+      r.insert (s.name);
+    return r;
+  }
 }
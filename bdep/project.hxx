@@ -4,7 +4,10 @@
 #ifndef BDEP_PROJECT_HXX
 #define BDEP_PROJECT_HXX
 
+#include <unordered_set>
+
 #include <odb/core.hxx>
+#include <odb/section.hxx>
 
 #include <libbutl/b.hxx>
 
@@ -19,7 +22,7 @@
 //
 #define DB_SCHEMA_VERSION_BASE 2
 
-#pragma db model version(DB_SCHEMA_VERSION_BASE, 2, closed)
+#pragma db model version(DB_SCHEMA_VERSION_BASE, 7, closed)
 
 // Prevent assert() macro expansion in get/set expressions. This should appear
 // after all #include directives since the assert() macro is redefined in each
@@ -38,6 +41,9 @@ namespace bdep
   using optional_string = optional<string>;
   using optional_dir_path = optional<dir_path>;
 
+  #pragma db map type(path) as(string) \
+    to((?).string ()) from(bdep::path (?))
+
   #pragma db map type(dir_path) as(string) \
     to((?).string ()) from(bdep::dir_path (?))
 
@@ -52,6 +58,29 @@ namespace bdep
 
   #pragma db value(package_name) type("TEXT") options("COLLATE NOCASE")
 
+  // Set of package names for efficient lookups (for example, of packages
+  // initialized in a configuration). Note that package names are compared
+  // case-insensitively and so we calculate the hash (FNV-1a) of the
+  // lower-case representation.
+  //
+  struct package_name_hash
+  {
+    size_t
+    operator() (const package_name& n) const
+    {
+      size_t r (2166136261U);
+      for (char c: n.string ())
+      {
+        r ^= static_cast<unsigned char> (lcase (c));
+        r *= 16777619U;
+      }
+      return r;
+    }
+  };
+
+  using package_name_set = std::unordered_set<package_name,
+                                              package_name_hash>;
+
   // State of a package in a configuration.
   //
   // Pretty much everything about the package can change (including location
@@ -68,6 +97,17 @@ namespace bdep
     package_name name;
   };
 
+  // Member of the linked configuration cluster (see find_config_cluster() in
+  // sync.cxx for details).
+  //
+  #pragma db value
+  struct cluster_config
+  {
+    dir_path        path;
+    string          uuid;
+    optional_string fetch_cache_mode;
+  };
+
   // Configuration associated with a project.
   //
   #pragma db object pointer(shared_ptr) session
@@ -101,14 +141,74 @@ namespace bdep
     // more than a handful of packages. We may, however, want to use a change-
     // tracking vector later (e.g., to optimize updates).
     //
+    // Note that the package name column of the container table is indexed
+    // so that we can efficiently query for configurations that have a
+    // certain package initialized (see package_configuration below).
+    //
     vector<package_state> packages;
 
+    // Synchronization fingerprint.
+    //
+    // The checksum of the state (project manifests, bpkg databases of the
+    // linked configuration cluster, etc) against which this configuration
+    // was last successfully synchronized, the linked configuration cluster
+    // it was synchronized as part of, and the list of filesystem entries the
+    // checksum was calculated for. Used to turn an implicit synchronization
+    // into a noop if nothing has changed (see sync.cxx for details).
+    //
+    // Note that this state is only needed during synchronization and so we
+    // load it lazily.
+    //
+    optional_string sync_fingerprint;
+    dir_paths       sync_cluster;
+    paths           sync_paths;
+
+    // Linked configuration cluster cache.
+    //
+    // The linked configuration cluster this configuration belongs to (along
+    // with the members' fetch cache modes), as reported by bpkg-cfg-info,
+    // and the checksum of the cluster members'
+    // bpkg databases modification times it is valid for. Loaded lazily
+    // together with the synchronization fingerprint.
+    //
+    vector<cluster_config> cluster;
+    optional_string        cluster_stamp;
+
+    odb::section sync_section;
+
+    // Fetch freshness.
+    //
+    // The time (in nanoseconds since epoch) and depth (see fetch_depth in
+    // fetch.hxx) of the last successful fetch of the project repository in
+    // this configuration as well as the checksum of the project repository
+    // state it was performed for. Used to skip redundant fetches (see
+    // --fetch-max-age for details). Loaded lazily.
+    //
+    optional_uint64_t fetch_time;
+    optional_uint64_t fetch_depth;
+    optional_string   fetch_stamp;
+
+    odb::section fetch_section;
+
     // Database mapping.
     //
     #pragma db member(id) id auto
     #pragma db member(name) unique
     #pragma db member(path) unique
     #pragma db member(packages) value_column("")
+    #pragma db index member(packages.value)
+
+    #pragma db member(sync_fingerprint) section(sync_section)
+    #pragma db member(sync_cluster) section(sync_section)
+    #pragma db member(sync_paths) section(sync_section)
+    #pragma db member(cluster) value_column("") section(sync_section)
+    #pragma db member(cluster_stamp) section(sync_section)
+    #pragma db member(sync_section) load(lazy) update(manual)
+
+    #pragma db member(fetch_time) section(fetch_section)
+    #pragma db member(fetch_depth) section(fetch_section)
+    #pragma db member(fetch_stamp) section(fetch_section)
+    #pragma db member(fetch_section) load(lazy) update(manual)
 
     // Make path comparison case-insensitive for certain platforms.
     //
@@ -144,6 +244,12 @@ namespace bdep
         auto_sync (as),
         packages (move (ps)) {}
 
+    // Return the names of the initialized packages as a set, for example, to
+    // look up multiple packages without scanning the vector for each.
+    //
+    package_name_set
+    package_index () const;
+
   private:
     friend class odb::access;
     configuration () = default;
@@ -162,6 +268,23 @@ namespace bdep
     return os;
   }
 
+  // Configuration data without the packages and the lazily loaded sections.
+  // Used to cheaply list configurations when their packages are not needed.
+  //
+  #pragma db view object(configuration)
+  struct configuration_info
+  {
+    optional_uint64_t  id;
+    optional_string    name;
+    string             type;
+    dir_path           path;
+    optional_dir_path  relative_path;
+
+    bool default_;
+    bool forward;
+    bool auto_sync;
+  };
+
   #pragma db view object(configuration)
   struct configuration_count
   {
@@ -171,6 +294,31 @@ namespace bdep
     operator size_t () const {return result;}
   };
 
+  // Package initialized in a configuration (id and flags).
+  //
+  // Allows answering the "which configurations have package X initialized"
+  // question with a single query rather than by loading every configuration
+  // object with all its packages. Note that the package name column can be
+  // referred to in queries as "cp.name".
+  //
+  #pragma db view object(configuration)                     \
+    table("configuration_packages" = "cp" inner:            \
+          "cp.object_id = " + configuration::id)
+  struct package_configuration
+  {
+    #pragma db column(configuration::id)
+    uint64_t id;
+
+    #pragma db column(configuration::default_)
+    bool default_;
+
+    #pragma db column(configuration::forward)
+    bool forward;
+
+    #pragma db column("cp.name")
+    package_name name;
+  };
+
   // Given the project directory, database, and options resolve all the
   // mentioned configurations or, unless fallback_default is false, find the
   // default configurations if none were mentioned. Unless validate is false,
@@ -213,6 +361,13 @@ namespace bdep
                         bool allow_subdir,
                         bool ignore_not_found = false);
 
+  // Clear the find_project_package() results cached for the duration of the
+  // process. Should be called by commands that create the project or package
+  // root markers (.bdep/, manifests, etc).
+  //
+  void
+  clear_project_package_cache ();
+
   // Given the project options (and CWD) locate the packages and their
   // project. The result is an absolute and normalized project directory and a
   // vector of relative (to the project directory) package locations.
@@ -246,6 +401,12 @@ namespace bdep
     //
     void
     append (package_locations&&);
+
+    // Return the package names as a set (see configuration::package_index()
+    // for details).
+    //
+    package_name_set
+    package_index () const;
   };
 
   // Search project packages in the specified directories or the current
@@ -317,6 +478,41 @@ namespace bdep
   verify_project_packages (const project_packages&,
                            const pair<configurations, bool>&);
 
+  // As above but query the project database instead of examining the loaded
+  // configuration objects, which is cheaper for large numbers of packages.
+  //
+  void
+  verify_project_packages (const project_packages&,
+                           const pair<configurations, bool>&,
+                           transaction&);
+
+  // Return true if the configurations may be linked with each other, that
+  // is, belong to the same linked configuration cluster as cached in the
+  // project database (see configuration::cluster for details). Assume they
+  // may be if the cluster is not cached for either of them.
+  //
+  // Note that the configurations' sync sections are expected to be loaded.
+  //
+  bool
+  configurations_linked (const configuration&, const configuration&);
+
+  // Split the configurations into waves so that no two configurations in a
+  // wave are linked with each other (see above) and can therefore be
+  // operated on concurrently without locking each other out or racing on a
+  // shared linked configuration (such as a host configuration with
+  // build-time dependencies). Return the waves as lists of indexes into the
+  // specified vector, preserving the configuration order.
+  //
+  // If ordered is true, then split the configurations into consecutive waves
+  // only, starting a new wave on the first configuration linked with some
+  // configuration in the current wave. This way processing the waves one
+  // after another preserves the configuration order (for example, of the
+  // output).
+  //
+  vector<vector<size_t>>
+  unlinked_waves (const vector<reference_wrapper<const configuration>>&,
+                  bool ordered = false);
+
   // Determine the version of a package in the specified package (first
   // version) or configuration (second version) directory.
   //
@@ -328,6 +524,13 @@ namespace bdep
                    const dir_path& cfg,
                    const package_name&);
 
+  // As the first version above but for multiple package directories,
+  // obtaining the versions with a single build system invocation. Return the
+  // versions in the directory order.
+  //
+  vector<standard_version>
+  package_versions (const common_options&, const dir_paths& pkgs);
+
   // Obtain build2 project info for package source or output directory.
   //
   using package_info = butl::b_project_info;
@@ -336,6 +539,13 @@ namespace bdep
   package_info
   package_b_info (const common_options&, const dir_path&, b_info_flags);
 
+  // As above but for multiple package directories, obtaining the info for
+  // all of them with a single build system invocation. Return the infos in
+  // the directory order.
+  //
+  vector<package_info>
+  package_b_info (const common_options&, const dir_paths&, b_info_flags);
+
   // Verify that the package name matches what we expect it to be and the
   // package uses a standard version.
   //
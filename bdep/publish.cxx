@@ -160,6 +160,12 @@ namespace bdep
           info << "use --force=uncommitted to publish anyway";
     }
 
+    // Query the information for all the packages with a single build system
+    // invocation.
+    //
+    vector<package_info> pis (
+      package_b_info (o, dist_dirs, b_info_flags::none));
+
     for (size_t i (0); i != pkg_locs.size (); ++i)
     {
       package_location& pl (pkg_locs[i]);
@@ -173,7 +179,7 @@ namespace bdep
       // way to deduce it and thus it needs to be specified explicitly.
       //
       string s; // Section.
-      package_info pi (package_b_info (o, d, b_info_flags::none));
+      const package_info& pi (pis[i]);
 
       if (!pi.version.empty ()) // Does the package use the standard version?
       {
@@ -1080,11 +1086,22 @@ namespace bdep
       //
       dir_paths cfgs; // Configuration directories to sync.
 
+      // Query the information for all the packages with a single build
+      // system invocation.
+      //
+      dir_paths ds;
+      ds.reserve (pkgs.size ());
+
       for (const package_location& pl: pkgs)
-      {
-        dir_path d (prj / pl.path);
+        ds.push_back (prj / pl.path);
+
+      vector<package_info> pis (package_b_info (o, ds, b_info_flags::none));
 
-        package_info pi (package_b_info (o, d, b_info_flags::none));
+      for (size_t i (0); i != pkgs.size (); ++i)
+      {
+        const package_location& pl (pkgs[i]);
+        dir_path& d (ds[i]);
+        package_info& pi (pis[i]);
 
         if (pi.src_root == pi.out_root)
           fail << "package " << pl.name << " source directory is not forwarded" <<
@@ -1124,13 +1141,16 @@ namespace bdep
       {
         // Don't keep the database open longer than necessary.
         //
-        database db (open (prj, o.sqlite_synchronous (), trace));
+        database db (open (prj,
+                           o.sqlite_synchronous (),
+                           trace,
+                           false /* create */,
+                           true  /* shared */));
 
         transaction t (db.begin ());
         cfgs = find_configurations (o, prj, t);
+        verify_project_packages (pp, cfgs, t);
         t.commit ();
-
-        verify_project_packages (pp, cfgs);
       }
 
       // Configurations to sync.
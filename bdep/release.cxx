@@ -644,13 +644,15 @@ namespace bdep
 
     // Fully parse package manifest verifying it is valid and returning the
     // position of the version value (first) and positions of *-version values
-    // (second).
+    // (second). The actual package version (with the snapshot information,
+    // etc) is expected to be obtained by the caller with package_versions()
+    // which queries all the packages at once.
     //
     // In a sense we are publishing (by tagging) to a version control-based
     // repository and it makes sense to ensure the repository will not be
     // broken, similar to how we do it in publish.
     //
-    auto parse_manifest = [&o] (const path& f)
+    auto parse_manifest = [] (const path& f, const standard_version& pv)
     {
       using bpkg::version;
       using bpkg::package_manifest;
@@ -693,10 +695,10 @@ namespace bdep
         // translation is required.
         //
         package_manifest m (p,
-                            [&o, &d, &r] (version& v)
+                            [&pv, &r] (version& v)
                             {
                               r.first.value = v.string (); // For good measure.
-                              v = version (package_version (o, d).string ());
+                              v = version (pv.string ());
                             });
 
         // Validate the *-file manifest values expansion.
@@ -803,13 +805,28 @@ namespace bdep
         pls = load_packages (prj.path);
       }
 
-      for (package_location& pl: pls)
+      // Obtain the actual versions of all the packages at once.
+      //
+      vector<standard_version> pvs;
       {
+        dir_paths ds;
+        ds.reserve (pls.size ());
+
+        for (const package_location& pl: pls)
+          ds.push_back (prj.path / pl.path);
+
+        pvs = package_versions (o, ds);
+      }
+
+      for (size_t i (0); i != pls.size (); ++i)
+      {
+        package_location& pl (pls[i]);
+
         // Parse each manifest extracting name, version, position, etc.
         //
         path f (prj.path / pl.path / manifest_file);
         pair<manifest_name_value, vector<manifest_name_value>> r (
-          parse_manifest (f));
+          parse_manifest (f, pvs[i]));
 
         package_name n (move (pl.name));
         standard_version v;
@@ -1042,23 +1059,9 @@ namespace bdep
 
           // Rewrite the version.
           //
-          {
-            manifest_rewriter rw (p.manifest);
-            vv.value = p.release_version->string ();
-            rw.replace (vv);
-          }
-
-          // If we also need to open the next development cycle, update the
-          // version positions for the subsequent manifest rewrite.
-          //
-          if (prj.open_version)
-          {
-            pair<manifest_name_value, vector<manifest_name_value>> r (
-              parse_manifest (p.manifest));
-
-            vv = move (r.first);
-            p.other_version_pos = move (r.second);
-          }
+          manifest_rewriter rw (p.manifest);
+          vv.value = p.release_version->string ();
+          rw.replace (vv);
         }
         // The IO failure is unlikely to happen (as we have already read the
         // manifests) but still possible (write permission is denied, device
@@ -1074,6 +1077,33 @@ namespace bdep
         }
       }
 
+      // If we also need to open the next development cycle, update the
+      // version positions for the subsequent manifest rewrite. Note that
+      // we do it after rewriting all the manifests so that we can obtain
+      // the package versions at once.
+      //
+      if (prj.open_version)
+      {
+        dir_paths ds;
+        ds.reserve (prj.packages.size ());
+
+        for (const package& p: prj.packages)
+          ds.push_back (p.manifest.directory ());
+
+        vector<standard_version> pvs (package_versions (o, ds));
+
+        for (size_t i (0); i != prj.packages.size (); ++i)
+        {
+          package& p (prj.packages[i]);
+
+          pair<manifest_name_value, vector<manifest_name_value>> r (
+            parse_manifest (p.manifest, pvs[i]));
+
+          p.version_pos = move (r.first);
+          p.other_version_pos = move (r.second);
+        }
+      }
+
       // If not committing, then we are done.
       //
       // In this case it would have been nice to pre-populate the commit
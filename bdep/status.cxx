@@ -5,73 +5,82 @@
 
 #include <iostream> // cout
 
+#include <libbutl/json/parser.hxx>
 #include <libbutl/json/serializer.hxx>
 
 #include <bdep/project.hxx>
 #include <bdep/database.hxx>
+#include <bdep/project-odb.hxx>
 #include <bdep/diagnostics.hxx>
 
+#include <bdep/sync.hxx>  // bpkg_stamp()
 #include <bdep/fetch.hxx>
 
 using namespace std;
 
 namespace bdep
 {
-  // If the specified package list is not empty, then return only those
+  // If the specified package set is not empty, then return only those
   // packages which are initialized in the specified configuration. Otherwise,
   // return all packages that have been initialized in this configuration.
   //
   static strings
-  config_packages (const configuration& cfg, const package_locations& pkgs)
+  config_packages (const configuration& cfg, const package_name_set& pkgs)
   {
     strings r;
 
     bool all (pkgs.empty ());
     for (const package_state& s: cfg.packages)
     {
-      if (all ||
-          find_if (pkgs.begin (),
-                   pkgs.end (),
-                   [&s] (const package_location& p)
-                   {
-                     return p.name == s.name;
-                   }) != pkgs.end ())
+      if (all || pkgs.find (s.name) != pkgs.end ())
         r.push_back (s.name.string ());
     }
 
     return r;
   }
 
+  // Fetch in the configuration prior to querying the status: explicitly,
+  // if requested, and shallow fetch the project otherwise to make sure we
+  // show latest iterations and pick up any new repositories.
+  //
+  static process
+  start_bpkg_fetch (const cmd_status_options& o,
+                    int out,
+                    int err,
+                    const dir_path& prj,
+                    const shared_ptr<configuration>& c)
+  {
+    if (o.fetch () || o.fetch_full ())
+      return start_fetch (o, prj, c, o.fetch_full (), out, err);
+
+    // We do it in a separate command for the same reason as in sync.
+    //
+    return start_bpkg (3,
+                       o,
+                       out,
+                       err,
+                       "fetch",
+                       "-d", c->path,
+                       "--shallow",
+                       "--no-dir-progress",
+                       repository_name (prj));
+  }
+
   static process
   start_bpkg_status (const cmd_status_options& o,
                      int out,
-                     const dir_path& prj,
+                     int err,
                      const dir_path& cfg,
                      const strings& pkgs,
-                     bool fetch,
                      const char* format)
   {
-    // Shallow fetch the project to make sure we show latest iterations and
-    // pick up any new repositories.
-    //
-    // We do it in a separate command for the same reason as in sync.
-    //
-    if (fetch)
-      run_bpkg (3,
-                o,
-                "fetch",
-                "-d", cfg,
-                "--shallow",
-                "--no-dir-progress",
-                repository_name (prj));
-
     // Don't show the hold status since the only packages that will normally
     // be held are the project's. But do show dependency constraints.
     //
     return start_bpkg (2 /* verbosity */,
                        o,
                        out,
-                       2 /* stderr */,
+                       err,
                        "status",
                        "-d", cfg,
                        "--no-hold",
@@ -83,6 +92,193 @@ namespace bdep
                        pkgs);
   }
 
+  // The configurations to print the status in (indexes in the configuration
+  // list) together with the packages to print the status for.
+  //
+  using status_configs = vector<pair<size_t, strings>>;
+
+  // Return the maximum number of configurations to fetch and print the
+  // status in concurrently (see --parallel for details).
+  //
+  static size_t
+  status_jobs (const cmd_status_options& o, const status_configs& scs)
+  {
+    return o.parallel_specified ()
+      ? (o.parallel () != 0 ? o.parallel () : scs.size ())
+      : 1;
+  }
+
+  // Split the configurations to print the status in into consecutive waves
+  // of configurations that are not linked with each other, returning them
+  // as lists of indexes in scs.
+  //
+  // Note that bpkg attaches the databases of the configurations linked with
+  // the one it operates on, locking them exclusively. So we only fetch and
+  // query the status concurrently in configurations that are not linked
+  // with each other, according to the clusters cached in the project
+  // database (see unlinked_waves() for details). Also note that the waves
+  // are consecutive so that the status is still printed in the
+  // configuration order.
+  //
+  // Note also that the configurations' sync sections are expected to be
+  // loaded if running concurrently.
+  //
+  static vector<vector<size_t>>
+  status_waves (const configurations& cfgs,
+                const status_configs& scs,
+                size_t jobs)
+  {
+    vector<vector<size_t>> r;
+
+    if (jobs > 1 && scs.size () > 1)
+    {
+      vector<reference_wrapper<const configuration>> cs;
+      for (const auto& sc: scs)
+        cs.push_back (*cfgs[sc.first]);
+
+      r = unlinked_waves (cs, true /* ordered */);
+    }
+    else if (!scs.empty ())
+    {
+      r.push_back (vector<size_t> ());
+      for (size_t i (0); i != scs.size (); ++i)
+        r.back ().push_back (i);
+    }
+
+    return r;
+  }
+
+  // The configurations to fetch in prior to querying the status, skipping
+  // those recently fetched in (see --fetch-max-age for details).
+  //
+  struct status_fetch
+  {
+    fetch_depth  depth;
+    string       stamp;
+    timestamp    start;
+    vector<bool> fetch; // Parallel to status_configs.
+
+    status_fetch (const cmd_status_options& o,
+                  const dir_path& prj,
+                  const configurations& cfgs,
+                  const status_configs& scs)
+        : depth (o.fetch_full () ? fetch_depth::full  :
+                 o.fetch ()      ? fetch_depth::deep  :
+                                   fetch_depth::shallow),
+          start (std::chrono::system_clock::now ())
+    {
+      if (!scs.empty ())
+        stamp = fetch_stamp (o, prj);
+
+      for (const auto& sc: scs)
+        fetch.push_back (!fetch_skip (o, prj, *cfgs[sc.first], depth, stamp));
+    }
+
+    // Save the fetch information for the configurations we have fetched in.
+    //
+    void
+    save (const cmd_status_options& o,
+          const dir_path& prj,
+          const configurations& cfgs,
+          const status_configs& scs) const
+    {
+      configurations fcfgs;
+      for (size_t i (0); i != scs.size (); ++i)
+      {
+        if (fetch[i])
+        {
+          const shared_ptr<configuration>& c (cfgs[scs[i].first]);
+
+          fetch_performed (prj, *c, depth);
+          fcfgs.push_back (c);
+        }
+      }
+
+      save_fetch_info (o, prj, fcfgs, depth, stamp, start);
+    }
+  };
+
+  // If we print the status in multiple configurations concurrently, then
+  // fetch in all of them concurrently beforehand. Return true if we did.
+  //
+  static bool
+  prefetch (const cmd_status_options& o,
+            const dir_path& prj,
+            const configurations& cfgs,
+            const status_configs& scs,
+            const status_fetch& sf,
+            size_t jobs)
+  {
+    if (jobs <= 1 || scs.size () <= 1)
+      return false;
+
+    vector<size_t> fcs; // Indexes in scs.
+    for (size_t i (0); i != scs.size (); ++i)
+    {
+      if (sf.fetch[i])
+        fcs.push_back (i);
+    }
+
+    // If fetching deep, then fetch in the first configuration before the
+    // rest so that they can reuse the prerequisite and complement
+    // repositories from the fetch cache (see fetch_waves() for details).
+    //
+    vector<size_t> order;
+    size_t first (fcs.size ());
+
+    if (sf.depth != fetch_depth::shallow)
+    {
+      pair<vector<size_t>, size_t> ws (
+        fetch_waves (o, vector<strings> (fcs.size (),
+                                         strings {repository_name (prj)})));
+
+      order = move (ws.first);
+      first = ws.second;
+    }
+    else
+    {
+      for (size_t i (0); i != fcs.size (); ++i)
+        order.push_back (i);
+    }
+
+    // Only fetch concurrently in configurations that are not linked with
+    // each other (see status_waves() for details).
+    //
+    auto fetch = [&o, &prj, &cfgs, &scs, &fcs, &order, jobs] (size_t b,
+                                                            size_t e)
+    {
+      vector<reference_wrapper<const configuration>> cs;
+      for (size_t i (b); i != e; ++i)
+        cs.push_back (*cfgs[scs[fcs[order[i]]].first]);
+
+      for (const vector<size_t>& w: unlinked_waves (cs))
+      {
+        run_concurrently (
+          jobs,
+          w.size (),
+          nullptr /* intro */,
+          [&o, &prj, &cfgs, &scs, &fcs, &order, &w, b] (size_t i,
+                                                        int out,
+                                                        int err)
+          {
+            const shared_ptr<configuration>& c (
+              cfgs[scs[fcs[order[b + w[i]]]].first]);
+
+            return start_bpkg_fetch (o, out, err, prj, c);
+          },
+          [&o] (size_t, process& pr)
+          {
+            finish_bpkg (o, pr);
+          });
+      }
+    };
+
+    fetch (0, first);
+    fetch (first, order.size ());
+
+    return true;
+  }
+
   static void
   cmd_status_lines (const cmd_status_options& o,
                     const project_packages& prj_pkgs,
@@ -91,70 +287,124 @@ namespace bdep
   {
     tracer trace ("status_lines");
 
-    // Print status in each configuration, skipping fetching repositories in
-    // those where no package statuses needs to be printed.
+    const dir_path& prj (prj_pkgs.project);
+
+    // Collect the configurations to print the status in and the packages to
+    // print, unless the dependency packages are specified.
     //
-    bool first (true);
-    for (const shared_ptr<configuration>& c: cfgs)
+    status_configs scs;
+    package_name_set pns (prj_pkgs.package_index ());
+
+    for (size_t i (0); i != cfgs.size (); ++i)
     {
-      // Collect the packages to print, unless the dependency packages are
-      // specified.
-      //
+      const shared_ptr<configuration>& c (cfgs[i]);
+
       strings pkgs;
 
       if (dep_pkgs.empty ())
-        pkgs = config_packages (*c, prj_pkgs.packages);
+        pkgs = config_packages (*c, pns);
+
+      if (!c->packages.empty () && (!pkgs.empty () || !dep_pkgs.empty ()))
+      {
+        // Status for either packages or their dependencies must be printed,
+        // but not for both.
+        //
+        assert (pkgs.empty () == !dep_pkgs.empty ());
 
+        scs.emplace_back (i, !pkgs.empty () ? move (pkgs) : dep_pkgs);
+      }
+    }
+
+    size_t jobs (status_jobs (o, scs));
+    status_fetch sf (o, prj, cfgs, scs);
+    bool fetched (prefetch (o, prj, cfgs, scs, sf, jobs));
+
+    // Print status in each configuration, skipping fetching repositories in
+    // those where no package statuses needs to be printed.
+    //
+    // Note that if printing the status in multiple configurations
+    // concurrently, the bpkg-status output is buffered and the configuration
+    // header is printed (in order) when it completes (see
+    // run_concurrently() and status_waves() for details).
+    //
+    bool first (true);
+    auto header = [&cfgs, &first] (const configuration& c)
+    {
       // If we are printing multiple configurations, separate them with a
       // blank line and print the configuration name/directory.
       //
       if (verb && cfgs.size () > 1)
       {
         cout << (first ? "" : "\n")
-             << "in configuration " << *c << ':' << endl;
+             << "in configuration " << c << ':' << endl;
 
         first = false;
       }
+    };
 
-      if (!c->packages.empty () && (!pkgs.empty () || !dep_pkgs.empty ()))
+    // Print the headers and skip the configurations preceding the specified
+    // one where no package statuses needs to be printed.
+    //
+    size_t next (0);
+    auto skip = [&cfgs, &header, &next] (size_t e)
+    {
+      for (; next != e; ++next)
       {
-        const dir_path& prj (prj_pkgs.project);
-
-        bool fetch (o.fetch () || o.fetch_full ());
+        const configuration& c (*cfgs[next]);
 
-        if (fetch)
-          cmd_fetch (o, prj, c, o.fetch_full ());
+        header (c);
 
-        // Status for either packages or their dependencies must be printed,
-        // but not for both.
-        //
-        assert (pkgs.empty () == !dep_pkgs.empty ());
-
-        process pr (start_bpkg_status (o,
-                                       1 /* stdout */,
-                                       prj,
-                                       c->path,
-                                       !pkgs.empty () ? pkgs : dep_pkgs,
-                                       !fetch,
-                                       "lines"));
-
-        finish_bpkg (o, pr);
-      }
-      else
-      {
         if (verb)
         {
           diag_record dr (info);
 
-          if (c->packages.empty ())
+          if (c.packages.empty ())
             dr << "no packages ";
           else
             dr << "none of specified packages ";
 
-          dr << "initialized in configuration " << *c << ", skipping";
+          dr << "initialized in configuration " << c << ", skipping";
         }
       }
+    };
+
+    for (const vector<size_t>& w: status_waves (cfgs, scs, jobs))
+    {
+      run_concurrently (
+        jobs,
+        w.size (),
+        [&cfgs, &scs, &header, &skip, &next, &w] (size_t i)
+        {
+          skip (scs[w[i]].first);
+          header (*cfgs[next++]);
+        },
+        [&o, &prj, &cfgs, &scs, &sf, fetched, &w] (size_t i, int out, int err)
+        {
+          size_t j (w[i]);
+          const shared_ptr<configuration>& c (cfgs[scs[j].first]);
+
+          if (!fetched && sf.fetch[j])
+          {
+            process pr (start_bpkg_fetch (o, out, err, prj, c));
+            finish_bpkg (o, pr);
+          }
+
+          return start_bpkg_status (o,
+                                    out,
+                                    err,
+                                    c->path,
+                                    scs[j].second,
+                                    "lines");
+        },
+        [&o] (size_t, process& pr)
+        {
+          finish_bpkg (o, pr);
+        });
     }
+
+    skip (cfgs.size ());
+
+    sf.save (o, prj, cfgs, scs);
   }
 
   static void
@@ -165,180 +415,319 @@ namespace bdep
   {
     tracer trace ("status_json");
 
+    const dir_path& prj (prj_pkgs.project);
+
+    // Collect the configurations to retrieve the package statuses in and the
+    // initialized packages to print, unless the dependency packages are
+    // specified.
+    //
+    // If we print statuses of the dependency packages, then retrieve them
+    // all as bpkg-status' stdout. Otherwise, retrieve the initialized
+    // packages statuses, if any, as bpkg-status' stdout and append statuses
+    // of uninitialized packages, if any (see below).
+    //
+    status_configs scs;
+    package_name_set pns (prj_pkgs.package_index ());
+
+    for (size_t i (0); i != cfgs.size (); ++i)
+    {
+      const shared_ptr<configuration>& c (cfgs[i]);
+
+      strings pkgs;
+
+      if (dep_pkgs.empty ())
+        pkgs = config_packages (*c, pns);
+
+      if (!c->packages.empty () && (!pkgs.empty () || !dep_pkgs.empty ()))
+      {
+        // Status for either packages or their dependencies must be printed,
+        // but not for both.
+        //
+        assert (pkgs.empty () == !dep_pkgs.empty ());
+
+        scs.emplace_back (i, !pkgs.empty () ? move (pkgs) : dep_pkgs);
+      }
+    }
+
+    size_t jobs (status_jobs (o, scs));
+    status_fetch sf (o, prj, cfgs, scs);
+    bool fetched (prefetch (o, prj, cfgs, scs, sf, jobs));
+
     butl::json::stream_serializer ss (cout);
 
     ss.begin_array ();
 
-    // Print status in each configuration, skipping fetching repositories in
-    // those where no package statuses need to be printed.
+    // Print status in the specified configuration. If the parser is
+    // specified, then forward the statuses of the project packages or their
+    // dependencies from the bpkg-status output (a JSON array) as the value
+    // of the packages member of the configuration packages status object,
+    // appending the uninitialized packages statuses, unless we are printing
+    // the dependency packages. Return false if the bpkg-status output is not
+    // a JSON array.
+    //
+    // Note that we parse the bpkg-status output and forward it event by
+    // event rather than reading it as a whole, so that we don't need to keep
+    // it in memory and can start printing while bpkg-status is still
+    // running. This, however, means that if the output turns out to be
+    // invalid, then we will have printed a partial value before failing.
     //
-    for (const shared_ptr<configuration>& c: cfgs)
+    auto print = [&ss, &prj_pkgs, &dep_pkgs] (const configuration& c,
+                                              butl::json::parser* p) -> bool
     {
+      using butl::json::event;
+
       ss.begin_object ();
       ss.member_name ("configuration", false /* check */);
       ss.begin_object ();
-      ss.member ("id", *c->id);
-      ss.member ("path", c->path.string ());
+      ss.member ("id", *c.id);
+      ss.member ("path", c.path.string ());
 
-      if (c->name)
-        ss.member ("name", *c->name);
+      if (c.name)
+        ss.member ("name", *c.name);
 
       ss.end_object ();
 
-      // Collect the initialized packages to print, unless the dependency
-      // packages are specified.
-      //
-      strings pkgs;
+      vector<reference_wrapper<const package_name>> ups; // Uninitialized.
 
       if (dep_pkgs.empty ())
-        pkgs = config_packages (*c, prj_pkgs.packages);
+      {
+        package_name_set cpkgs (c.package_index ());
 
-      // Statuses of the project packages or their dependencies represented as
-      // a JSON array. Will be used as a pre-serialized value for the packages
-      // member of the configuration packages status object.
-      //
-      string ps;
+        for (const package_location& l: prj_pkgs.packages)
+        {
+          if (cpkgs.find (l.name) == cpkgs.end ())
+            ups.push_back (l.name);
+        }
+      }
 
-      // If we print statuses of the dependency packages, then retrieve them
-      // all as bpkg-status' stdout. Otherwise, retrieve the initialized
-      // packages statuses, if any, as bpkg-status' stdout and append statuses
-      // of uninitialized packages, if any.
+      // Note that we can end up with no statuses (for example, when query
+      // the status of a dependency package in the empty configuration).
       //
-      const vector<package_state>& cpkgs (c->packages);
-      if (!cpkgs.empty () && (!pkgs.empty () || !dep_pkgs.empty ()))
+      if (p != nullptr || !ups.empty ())
       {
-        const dir_path& prj (prj_pkgs.project);
-
-        bool fetch (o.fetch () || o.fetch_full ());
+        ss.member_name ("packages", false /* check */);
+        ss.begin_array ();
 
-        if (fetch)
-          cmd_fetch (o, prj, c, o.fetch_full ());
+        if (p != nullptr)
+        {
+          optional<event> e (p->next ());
 
-        // Status for either packages or their dependencies must be printed,
-        // but not for both.
-        //
-        assert (pkgs.empty () == !dep_pkgs.empty ());
+          if (!e || *e != event::begin_array)
+            return false;
 
-        fdpipe pipe (open_pipe ()); // Text mode seems appropriate.
+          // Forward the array elements.
+          //
+          for (size_t d (0);; ) // Nesting depth.
+          {
+            if (!(e = p->next ()))
+              return false; // Presumably the parser would have failed.
 
-        process pr (start_bpkg_status (o,
-                                       pipe.out.get (),
-                                       prj,
-                                       c->path,
-                                       !pkgs.empty () ? pkgs : dep_pkgs,
-                                       !fetch,
-                                       "json"));
+            if (*e == event::end_array && d == 0)
+              break;
 
-        // Shouldn't throw, unless something is severely damaged.
-        //
-        pipe.out.close ();
+            switch (*e)
+            {
+            case event::begin_object: ss.begin_object (); ++d; break;
+            case event::end_object:   ss.end_object ();   --d; break;
+            case event::begin_array:  ss.begin_array ();  ++d; break;
+            case event::end_array:    ss.end_array ();    --d; break;
+            case event::name:
+              {
+                ss.member_name (p->name (), false /* check */);
+                break;
+              }
+            case event::string:
+              {
+                ss.value (p->value (), false /* check */);
+                break;
+              }
+            case event::number:
+              {
+                ss.value_json_text (p->value ());
+                break;
+              }
+            case event::boolean:
+              {
+                ss.value (p->value<bool> ());
+                break;
+              }
+            case event::null:
+              {
+                ss.value (nullptr);
+                break;
+              }
+            }
+          }
 
-        bool io (false);
-        try
-        {
-          ifdstream is (move (pipe.in));
-          ps = is.read_text ();
-          is.close ();
+          if (p->next ()) // Not a single value?
+            return false;
         }
-        catch (const io_error&)
+
+        for (const package_name& n: ups)
         {
-          // Presumably the child process failed and issued diagnostics so let
-          // finish_bpkg() try to deal with that first.
-          //
-          io = true;
+          ss.begin_object ();
+          ss.member ("name", n.string ());
+          ss.member ("status", "uninitialized");
+          ss.end_object ();
         }
 
-        finish_bpkg (o, pr, io);
+        ss.end_array ();
+      }
 
-        // Trim the trailing newline, which must be present. Let's however
-        // check that it is, for good measure.
-        //
-        if (!ps.empty () && ps.back () == '\n')
-          ps.pop_back ();
+      ss.end_object ();
+      return true;
+    };
 
-        // While at it, let's verify that the output looks like a JSON array,
-        // since we will rely on the presence of the framing brackets below.
-        //
-        if (ps.empty () || ps.front () != '[' || ps.back () != ']')
-          fail << "invalid bpkg-status output:\n" << ps;
-      }
+    // Print status in the configurations preceding the specified one where
+    // no package statuses need to be retrieved.
+    //
+    size_t next (0);
+    auto skip = [&cfgs, &print, &next] (size_t e)
+    {
+      for (; next != e; ++next)
+        print (*cfgs[next], nullptr /* parser */);
+    };
 
-      // Append the uninitialized packages statuses to the JSON array, unless
-      // we are printing the dependency packages.
-      //
-      if (dep_pkgs.empty ())
-      {
-        // If the initialized packages are present and so the array
-        // representation is not empty, then unwrap the statuses removing the
-        // framing brackets before appending the uninitialized packages
-        // statuses and wrap them all back afterwards. Let's do it lazily.
-        //
-        bool first (true);
+    // Retrieve the package statuses, reading bpkg-status' stdout via a pipe,
+    // if running serially, and via a temporary file otherwise (see
+    // run_concurrently() for details). In both cases the output is parsed
+    // and printed as it is read (see above).
+    //
+    vector<auto_fd> ins (scs.size ());
+    vector<auto_rmfile> outs (scs.size ());
 
-        for (const package_location& l: prj_pkgs.packages)
+    for (const vector<size_t>& w: status_waves (cfgs, scs, jobs))
+    {
+      run_concurrently (
+        jobs,
+        w.size (),
+        nullptr /* intro */,
+        [&o, &prj, &cfgs, &scs, &sf, fetched, &ins, &outs, &w] (size_t j,
+                                                                int out,
+                                                                int err)
         {
-          if (find_if (cpkgs.begin (),
-                       cpkgs.end (),
-                       [&l] (const package_state& p)
-                       {
-                         return p.name == l.name;
-                       }) == cpkgs.end ()) // Unintialized?
+          size_t i (w[j]);
+          const shared_ptr<configuration>& c (cfgs[scs[i].first]);
+
+          if (!fetched && sf.fetch[i])
           {
-            // Unwrap the array representation, if present, on the first
-            // uninitialized package.
+            process pr (start_bpkg_fetch (o, out, err, prj, c));
+            finish_bpkg (o, pr);
+          }
+
+          if (out == 1) // Serial.
+          {
+            fdpipe pipe (open_pipe ()); // Text mode seems appropriate.
+
+            process pr (start_bpkg_status (o,
+                                           pipe.out.get (),
+                                           err,
+                                           c->path,
+                                           scs[i].second,
+                                           "json"));
+
+            // Shouldn't throw, unless something is severely damaged.
             //
-            if (first)
+            pipe.out.close ();
+
+            ins[i] = move (pipe.in);
+            return pr;
+          }
+          else
+          {
+            outs[i] = tmp_file ("status");
+
+            try
+            {
+              auto_fd fd (fdopen (outs[i].path,
+                                  fdopen_mode::out    |
+                                  fdopen_mode::create |
+                                  fdopen_mode::truncate));
+
+              return start_bpkg_status (o,
+                                        fd.get (),
+                                        err,
+                                        c->path,
+                                        scs[i].second,
+                                        "json");
+            }
+            catch (const io_error& e)
             {
-              first = false;
+              fail << "unable to open " << outs[i].path << ": " << e << endf;
+            }
+          }
+        },
+        [&o, &cfgs, &scs, &print, &skip, &next, &ins, &outs, &w] (
+          size_t j, process& pr)
+        {
+          size_t i (w[j]);
 
-              if (!ps.empty ())
-              {
-                size_t b (ps.find_first_not_of ("[\n"));
-                size_t e (ps.find_last_not_of ("\n]"));
+          skip (scs[i].first);
 
-                // We would fail earlier otherwise.
-                //
-                assert (b != string::npos && e != string::npos);
+          // Note that if the bpkg-status output is invalid, then the child
+          // process has presumably failed and issued diagnostics, so let
+          // finish_bpkg() try to deal with that first.
+          //
+          bool io (false);
+          bool valid (true);
+          optional<string> ie;     // Invalid JSON input description.
+          uint64_t il (0), ic (0); // Invalid JSON input line and column.
 
-                ps = string (ps, b, e + 1 - b);
-              }
+          auto read = [&cfgs, &print, &next, &valid, &ie, &il, &ic] (
+            ifdstream& is)
+          {
+            try
+            {
+              butl::json::parser p (is, "bpkg-status output");
+              valid = print (*cfgs[next++], &p);
+            }
+            catch (const butl::json::invalid_json_input& e)
+            {
+              ie = e.what ();
+              il = e.line;
+              ic = e.column;
             }
 
-            if (!ps.empty ())
-              ps += ",\n";
+            is.close ();
+          };
 
-            // Note: here we rely on the fact that the package name doesn't
-            // need escaping.
-            //
-            ps += "  {\n"
-                  "    \"name\": \"" + l.name.string () + "\",\n"
-                  "    \"status\": \"uninitialized\"\n"
-                  "  }";
+          try
+          {
+            if (ins[i].get () != -1)
+            {
+              ifdstream is (move (ins[i]),
+                            fdstream_mode::skip,
+                            ifdstream::badbit);
+              read (is);
+            }
+            else
+            {
+              ifdstream is (outs[i].path, ifdstream::badbit);
+              read (is);
+            }
+          }
+          catch (const io_error&)
+          {
+            io = true;
           }
-        }
 
-        // Wrap the array if any uninitialized packages statuses have been
-        // added.
-        //
-        if (!first)
-          ps = "[\n" + ps + "\n]";
-      }
+          finish_bpkg (o, pr, io);
 
-      // Note that we can end up with an empty statuses representation (for
-      // example, when query the status of a dependency package in the empty
-      // configuration).
-      //
-      if (!ps.empty ())
-      {
-        ss.member_name ("packages", false /* check */);
-        ss.value_json_text (ps);
-      }
+          if (ie)
+            fail << "invalid bpkg-status output: " << *ie <<
+              info << "line " << il << ", column " << ic;
 
-      ss.end_object ();
+          if (!valid)
+            fail << "invalid bpkg-status output: JSON array expected";
+        });
     }
 
+    skip (cfgs.size ());
+
     ss.end_array ();
     cout << endl;
+
+    sf.save (o, prj, cfgs, scs);
   }
 
   int
@@ -355,7 +744,11 @@ namespace bdep
 
     auto load_configurations = [&o, json, &trace] (const dir_path& prj)
     {
-      database db (open (prj, o.sqlite_synchronous (), trace));
+      database db (open (prj,
+                         o.sqlite_synchronous (),
+                         trace,
+                         false /* create */,
+                         true  /* shared */));
 
       transaction t (db.begin ());
 
@@ -371,6 +764,40 @@ namespace bdep
                              true /* validate */,
                              json /* allow_none */));
 
+      if (r)
+      {
+        load_fetch_info (o, db, r->first);
+
+        // Load the cached linked configuration clusters if we may fetch and
+        // query the status concurrently (see status_waves() for details).
+        //
+        // Note that, in contrast to update, etc., we don't pre-sync the
+        // configurations and so the cached clusters can be out of date (for
+        // example, after bdep-config-link). Thus, we treat a cluster as
+        // unknown (and the configuration as potentially linked with any
+        // other) unless its members' bpkg databases haven't changed since
+        // it was cached.
+        //
+        if (o.parallel_specified ())
+        {
+          for (const shared_ptr<configuration>& c: r->first)
+          {
+            if (!c->sync_section.loaded ())
+              db.load (*c, c->sync_section);
+
+            if (!c->cluster.empty ())
+            {
+              dir_paths ds;
+              for (const cluster_config& cc: c->cluster)
+                ds.push_back (cc.path);
+
+              if (!c->cluster_stamp || *c->cluster_stamp != bpkg_stamp (ds))
+                c->cluster.clear ();
+            }
+          }
+        }
+      }
+
       t.commit ();
 
       return r;
@@ -4,16 +4,21 @@
 #include <bdep/sync.hxx>
 
 #include <list>
+#include <sstream>
 #include <cstring>  // strchr(), strcmp(), strspn()
 
+#include <libbutl/sha256.hxx>
+
 #include <libbpkg/manifest.hxx>
 
 #include <bdep/database.hxx>
 #include <bdep/diagnostics.hxx>
 #include <bdep/project-odb.hxx>
 
+#include <bdep/git.hxx>
 #include <bdep/fetch.hxx>
 #include <bdep/config.hxx>
+#include <bdep/config-index.hxx>
 
 using namespace std;
 
@@ -22,15 +27,93 @@ namespace bdep
   const path hook_file (
     dir_path ("build") / "bootstrap" / "pre-bdep-sync.build");
 
+  string
+  sync_checksum (const strings& ss, const paths& ps)
+  {
+    butl::sha256 cs;
+
+    auto add = [&cs] (const string& s)
+    {
+      cs.append (s);
+      cs.append ("\n", 1);
+    };
+
+    for (const string& s: ss)
+      add (s);
+
+    for (const path& p: ps)
+    {
+      timestamp t;
+
+      try
+      {
+        t = file_mtime (p);
+      }
+      catch (const system_error& e)
+      {
+        fail << "unable to obtain modification time for " << p << ": " << e;
+      }
+
+      add (p.string ());
+      add (t != timestamp_nonexistent
+           ? to_string (t.time_since_epoch ().count ())
+           : "nonexistent");
+    }
+
+    return cs.string ();
+  }
+
+  // Note that bpkg may not have checkpointed the WAL file into the database
+  // yet.
+  //
+  string
+  bpkg_stamp (const dir_paths& cfgs)
+  {
+    paths ps;
+    for (const dir_path& d: cfgs)
+    {
+      path f (d / bpkg_file);
+      ps.push_back (f);
+      ps.push_back (move (f += "-wal"));
+    }
+
+    return sync_checksum (strings (), ps);
+  }
+
+  // Process-wide cache of the bpkg-rep-list results (the dir repository
+  // directories) for configurations along with the stamp (see bpkg_stamp())
+  // they are valid for.
+  //
+  struct repository_dirs
+  {
+    dir_path  config;
+    string    stamp;
+    dir_paths dirs;
+  };
+
+  static vector<repository_dirs> repository_dirs_cache;
+
   dir_paths
-  configuration_projects (const common_options& co,
-                          const dir_path& cfg,
-                          const dir_path& prj)
+  configuration_repositories (const common_options& co, const dir_path& cfg)
   {
     using bpkg::repository_type;
     using bpkg::repository_location;
 
-    dir_paths r;
+    // Reuse the cached result if the configuration hasn't changed.
+    //
+    string stamp (bpkg_stamp ({cfg}));
+
+    auto ci (find_if (repository_dirs_cache.begin (),
+                      repository_dirs_cache.end (),
+                      [&cfg] (const repository_dirs& rd)
+                      {
+                        return rd.config == cfg;
+                      }));
+
+    if (ci != repository_dirs_cache.end () && ci->stamp == stamp)
+      return ci->dirs;
+
+    dir_paths ds;
 
     // Use bpkg-rep-list to discover the list of project directories.
     //
@@ -90,15 +173,7 @@ namespace bdep
           fail << "invalid bpkg-rep-list output: " << e;
         }
 
-        if (d == prj)
-          continue;
-
-        // Next see if it looks like a bdep-managed project.
-        //
-        if (!exists (d / bdep_file))
-          continue;
-
-        r.push_back (move (d));
+        ds.push_back (move (d));
       }
 
       is.close (); // Detect errors.
@@ -113,6 +188,40 @@ namespace bdep
 
     finish_bpkg (co, pr, io);
 
+    if (ci != repository_dirs_cache.end ())
+    {
+      ci->stamp = move (stamp);
+      ci->dirs = ds;
+    }
+    else
+      repository_dirs_cache.push_back (repository_dirs {cfg, move (stamp), ds});
+
+    return ds;
+  }
+
+  dir_paths
+  configuration_projects (const common_options& co,
+                          const dir_path& cfg,
+                          const dir_path& prj)
+  {
+    dir_paths r;
+
+    // Note that the configuration index may be stale (see config-index.hxx
+    // for details).
+    //
+    for (dir_path& d: config_index_projects (co, cfg))
+    {
+      if (d == prj)
+        continue;
+
+      // Next see if it still looks like a bdep-managed project.
+      //
+      if (!exists (d / bdep_file))
+        continue;
+
+      r.push_back (move (d));
+    }
+
     return r;
   }
 
@@ -120,8 +229,9 @@ namespace bdep
   //
   struct linked_config
   {
-    dir_path   path;
-    bdep::uuid uuid;
+    dir_path         path;
+    bdep::uuid       uuid;
+    optional<string> fetch_cache_mode;
   };
 
   class linked_configs: public small_vector<linked_config, 16>
@@ -139,6 +249,19 @@ namespace bdep
     }
   };
 
+  // Return the checksum of the modification times of the cluster members'
+  // bpkg databases.
+  //
+  static string
+  cluster_stamp (const linked_configs& cfgs)
+  {
+    dir_paths ds;
+    for (const linked_config& cfg: cfgs)
+      ds.push_back (cfg.path);
+
+    return bpkg_stamp (ds);
+  }
+
   // Configurations to be synced are passed either as configuration objects
   // (if syncing from a project) or as directories (if syncing from a
   // configuration, normally implicit/hook).
@@ -191,106 +314,264 @@ namespace bdep
     return o;
   }
 
-  // Append the list of projects that are using this configuration. Note that
-  // if the project is already on the list, then add the configuration to the
-  // existing entry unless it's already there.
+  // Given that we can potentially be inside a transaction started on the
+  // origin project's database, the transaction handling is a bit
+  // complicated.
+  //
+  // If the transaction is specified, then assumed it is started on the
+  // specified project's database and so just wrap it.
+  //
+  // Otherwise, open the project database and start the transaction on it,
+  // stashing the current transaction, if present. In destructor restore the
+  // current transaction, if stashed.
+  //
+  class database_transaction
+  {
+  public:
+    database_transaction (transaction* t,
+                          const dir_path& prj,
+                          sqlite_synchronous sync,
+                          tracer& tr)
+        : ct_ (nullptr)
+    {
+      if (t == nullptr)
+      {
+        if (transaction::has_current ())
+        {
+          ct_ = &transaction::current ();
+          transaction::reset_current ();
+        }
+
+        db_.reset (new database_type (open (prj, sync, tr)));
+        t_.reset (db_->begin ());
+      }
+      else
+        ct_ = t;
+    }
+
+    ~database_transaction ()
+    {
+      if (ct_ != nullptr && db_ != nullptr)
+        transaction::current (*ct_);
+    }
+
+    void
+    commit ()
+    {
+      if (!t_.finalized ())
+        t_.commit ();
+    }
+
+    using database_type = bdep::database;
+
+    database_type&
+    database ()
+    {
+      assert (db_ != nullptr || ct_ != nullptr);
+      return db_ != nullptr ? *db_ : ct_->database ();
+    }
+
+    static transaction&
+    current ()
+    {
+      return transaction::current ();
+    }
+
+  private:
+    transaction               t_;
+    transaction*              ct_; // Current transaction.
+    unique_ptr<database_type> db_;
+  };
+
+  // Append the list of projects that are using the configurations of this
+  // cluster. Note that if the project is already on the list, then add the
+  // configuration to the existing entry unless it's already there.
+  //
+  // Note also that we open each project's database only once, querying for
+  // all the cluster configurations it is using at once.
   //
   static void
   load_implicit (const common_options& co,
-                 const dir_path& cfg,
+                 const linked_configs& cfgs,
                  sync_projects& r,
                  const dir_path& origin_prj,
                  transaction* origin_tr)
   {
     tracer trace ("load_implicit");
 
-    for (dir_path& d: configuration_projects (co, cfg))
+    // Projects and their configurations in the discovery order.
+    //
+    struct project
     {
-      // Do duplicate suppression before any heavy lifting.
-      //
-      auto i (find_if (r.begin (), r.end (),
-                       [&d] (const sync_project& p)
-                       {
-                         return p.path == d;
-                       }));
+      dir_path                          path;
+      strings                           config_paths;
+      vector<shared_ptr<configuration>> configs;
+    };
+    vector<project> prjs;
 
-      if (i != r.end ())
-      {
-        if (find_if (i->configs.begin (), i->configs.end (),
-                     [&cfg] (const sync_project::config& c)
-                     {
-                       return c->path == cfg;
-                     }) != i->configs.end ())
-          continue;
-      }
+    // The (project index, configuration) pairs in the discovery order.
+    //
+    vector<pair<size_t, reference_wrapper<const dir_path>>> pcs;
 
-      shared_ptr<configuration> c;
+    for (const linked_config& cfg: cfgs)
+    {
+      for (dir_path& d: configuration_projects (co, cfg.path))
       {
-        using query = bdep::query<configuration>;
-
-        query q (query::path == cfg.string ());
-
-        // Reuse the transaction (if any) if this is origin project.
+        // Do duplicate suppression before any heavy lifting.
         //
-        if (origin_tr != nullptr && origin_prj == d)
+        auto i (find_if (r.begin (), r.end (),
+                         [&d] (const sync_project& p)
+                         {
+                           return p.path == d;
+                         }));
+
+        if (i != r.end ())
         {
-          c = origin_tr->database ().query_one<configuration> (q);
+          if (find_if (i->configs.begin (), i->configs.end (),
+                       [&cfg] (const sync_project::config& c)
+                       {
+                         return c->path == cfg.path;
+                       }) != i->configs.end ())
+            continue;
         }
-        else
-        {
-          // Save and restore the current transaction, if any.
-          //
-          transaction* ct (nullptr);
-          if (transaction::has_current ())
-          {
-            ct = &transaction::current ();
-            transaction::reset_current ();
-          }
 
-          auto tg (make_guard ([ct] ()
-                               {
-                                 if (ct != nullptr)
-                                   transaction::current (*ct);
-                               }));
+        auto j (find_if (prjs.begin (), prjs.end (),
+                         [&d] (const project& p)
+                         {
+                           return p.path == d;
+                         }));
 
-          {
-            database db (open (d, co.sqlite_synchronous (), trace));
-            transaction t (db.begin ());
-            c = db.query_one<configuration> (q);
-            t.commit ();
-          }
+        if (j == prjs.end ())
+        {
+          prjs.push_back (project {move (d), {}, {}});
+          j = prjs.end () - 1;
         }
+
+        j->config_paths.push_back (cfg.path.string ());
+        pcs.emplace_back (j - prjs.begin (), cfg.path);
       }
+    }
+
+    for (project& p: prjs)
+    {
+      using query = bdep::query<configuration>;
+
+      // Reuse the transaction (if any) if this is origin project.
+      //
+      database_transaction t (p.path == origin_prj ? origin_tr : nullptr,
+                              p.path,
+                              co.sqlite_synchronous (),
+                              trace);
+
+      for (shared_ptr<configuration> c:
+             pointer_result (
+               t.database ().query<configuration> (
+                 query::path.in_range (p.config_paths.begin (),
+                                       p.config_paths.end ()))))
+        p.configs.push_back (move (c));
+
+      t.commit ();
+    }
+
+    for (const auto& pc: pcs)
+    {
+      project& p (prjs[pc.first]);
+      const dir_path& cfg (pc.second);
+
+      auto ci (find_if (p.configs.begin (), p.configs.end (),
+                        [&cfg] (const shared_ptr<configuration>& c)
+                        {
+                          return c->path == cfg;
+                        }));
 
       // If the project is a repository of this configuration but the bdep
       // database has no knowledge of this configuration, then assume it is
       // not managed by bdep (i.e., the user added the project manually or
       // some such).
       //
-      if (c == nullptr)
+      if (ci == p.configs.end ())
         continue;
 
+      auto i (find_if (r.begin (), r.end (),
+                       [&p] (const sync_project& sp)
+                       {
+                         return sp.path == p.path;
+                       }));
+
       if (i == r.end ())
       {
-        r.push_back (sync_project (d));
+        r.push_back (sync_project (p.path));
         i = r.end () - 1;
       }
 
       i->configs.push_back (
-        sync_project::config {move (c),
+        sync_project::config {*ci,
                               false /* origin */,
                               true  /* implicit */,
                               true  /* fetch */});
     }
   }
 
-  // Given the configuration directory, return its fetch cache mode, if any.
+  // Process-wide cache of the bpkg-cfg-info results along with the stamp
+  // (see cluster_stamp()) they are valid for.
   //
-  static optional<string>
-  find_fetch_cache_mode (const common_options& co, const dir_path& d)
+  struct config_cluster
+  {
+    linked_configs configs;
+    string         stamp;
+  };
+
+  static vector<config_cluster> config_cluster_cache;
+
+  // Add the cluster along with the stamp it is valid for to the process-wide
+  // cache, replacing its stale entry, if any.
+  //
+  static void
+  cache_config_cluster (const linked_configs& cfgs, string stamp)
   {
-    optional<string> r;
+    const dir_path& d (cfgs.front ().path);
 
+    auto ci (find_if (config_cluster_cache.begin (),
+                      config_cluster_cache.end (),
+                      [&d] (const config_cluster& c)
+                      {
+                        return c.configs.front ().path == d;
+                      }));
+
+    if (ci != config_cluster_cache.end ())
+    {
+      ci->configs = cfgs;
+      ci->stamp = move (stamp);
+    }
+    else
+      config_cluster_cache.push_back (config_cluster {cfgs, move (stamp)});
+  }
+
+  // Given the configuration directory, return absolute and normalized
+  // directories, UUIDs, and fetch cache modes of the entire linked
+  // configuration cluster. The specified configuration always comes first.
+  //
+  // Note that the result is cached for the lifetime of the process and is
+  // reused as long as none of the cluster configurations have changed.
+  //
+  static linked_configs
+  find_config_cluster (const common_options& co, const dir_path& d)
+  {
+    auto ci (find_if (config_cluster_cache.begin (),
+                      config_cluster_cache.end (),
+                      [&d] (const config_cluster& c)
+                      {
+                        return c.configs.front ().path == d;
+                      }));
+
+    if (ci != config_cluster_cache.end () &&
+        ci->stamp == cluster_stamp (ci->configs))
+      return ci->configs;
+
+    linked_configs r;
+
+    // Run bpkg-cfg-info to get the list of linked configurations.
+    //
     fdpipe pipe (open_pipe ()); // Text mode seems appropriate.
 
     process pr (start_bpkg (3,
@@ -298,35 +579,83 @@ namespace bdep
                             pipe /* stdout */,
                             2    /* stderr */,
                             "cfg-info",
-                            "-d", d));
+                            "-d", d,
+                            "--link",
+                            "--backlink",
+                            "--recursive"));
 
-    // Shouldn't throw, unless something is severely damaged.
-    //
-    pipe.out.close ();
+    pipe.out.close (); // Shouldn't throw unless very broken.
 
     bool io (false);
     try
     {
       ifdstream is (move (pipe.in), fdstream_mode::skip, ifdstream::badbit);
 
-      // Retrieve the configuration mode.
-      //
-      for (string l; !eof (getline (is, l)); )
+      string l; // Reuse the buffer.
+      do
       {
-        if (l.compare (0, 6, "mode: ") == 0)
+        linked_config c;
+
+        optional<pair<bool /* path */, bool /* uuid */>> s;
+        while (!eof (getline (is, l)))
         {
-          for (size_t b (0), e (0), n; (n = next_word (l, b, e, ' ')) != 0; )
+          if (!s)
+            s = make_pair (false, false);
+
+          if (l.empty ())
+            break;
+
+          if (l.compare (0, 6, "path: ") == 0)
           {
-            if (n > 12 && l.compare (b, 12, "fetch-cache=") == 0)
+            try
             {
-              r = string (l, b + 12, n - 12);
-              break;
+              c.path = dir_path (string (l, 6));
+              s->first = true;
+            }
+            catch (const invalid_path&)
+            {
+              fail << "invalid bpkg-cfg-info output line '" << l
+                   << "': invalid configuration path";
+            }
+          }
+          else if (l.compare (0, 6, "uuid: ") == 0)
+          {
+            try
+            {
+              c.uuid = uuid (string (l, 6));
+              s->second = true;
+            }
+            catch (const invalid_argument&)
+            {
+              fail << "invalid bpkg-cfg-info output line '" << l
+                   << "': invalid configuration uuid";
+            }
+          }
+          else if (l.compare (0, 6, "mode: ") == 0)
+          {
+            for (size_t b (0), e (0), n; (n = next_word (l, b, e, ' ')) != 0; )
+            {
+              if (n > 12 && l.compare (b, 12, "fetch-cache=") == 0)
+              {
+                c.fetch_cache_mode = string (l, b + 12, n - 12);
+                break;
+              }
             }
           }
+        }
+
+        if (s)
+        {
+          if (!s->first)
+            fail << "invalid bpkg-cfg-info output: missing configuration path";
 
-          break;
+          if (!s->second)
+            fail << "invalid bpkg-cfg-info output: missing configuration uuid";
+
+          r.push_back (move (c));
         }
       }
+      while (!is.eof ());
 
       is.close (); // Detect errors.
     }
@@ -340,9 +669,24 @@ namespace bdep
 
     finish_bpkg (co, pr, io);
 
+    if (r.empty ()) // We should have at least the main configuration.
+      fail << "invalid bpkg-cfg-info output: missing configuration information";
+
+    cache_config_cluster (r, cluster_stamp (r));
     return r;
   }
 
+  // Given the configuration directory, return its fetch cache mode, if any.
+  //
+  // Note that this normally doesn't run bpkg-cfg-info since the cluster has
+  // already been found (and cached) for the configuration being synced.
+  //
+  static optional<string>
+  find_fetch_cache_mode (const common_options& co, const dir_path& d)
+  {
+    return find_config_cluster (co, d).front ().fetch_cache_mode;
+  }
+
   // Find/create and link a configuration suitable for build-time dependency.
   //
   static void
@@ -476,78 +820,9 @@ namespace bdep
       return db.query_one<configuration> (query::path == cfg.string ());
     };
 
-    // Given that we can potentially be inside a transaction started on the
-    // origin project's database, the transaction handling is a bit
-    // complicated.
-    //
-    // If the transaction is specified, then assumed it is started on the
-    // specified project's database and so just wrap it.
-    //
-    // Otherwise, open the project database and start the transaction on it,
-    // stashing the current transaction, if present. In destructor restore the
-    // current transaction, if stashed.
+    // Show how we got here (used for both info and text).
     //
-    class database_transaction
-    {
-    public:
-      database_transaction (transaction* t,
-                            const dir_path& prj,
-                            sqlite_synchronous sync,
-                            tracer& tr)
-          : ct_ (nullptr)
-      {
-        if (t == nullptr)
-        {
-          if (transaction::has_current ())
-          {
-            ct_ = &transaction::current ();
-            transaction::reset_current ();
-          }
-
-          db_.reset (new database_type (open (prj, sync, tr)));
-          t_.reset (db_->begin ());
-        }
-        else
-          ct_ = t;
-      }
-
-      ~database_transaction ()
-      {
-        if (ct_ != nullptr && db_ != nullptr)
-          transaction::current (*ct_);
-      }
-
-      void
-      commit ()
-      {
-        if (!t_.finalized ())
-          t_.commit ();
-      }
-
-      using database_type = bdep::database;
-
-      database_type&
-      database ()
-      {
-        assert (db_ != nullptr || ct_ != nullptr);
-        return db_ != nullptr ? *db_ : ct_->database ();
-      }
-
-      static transaction&
-      current ()
-      {
-        return transaction::current ();
-      }
-
-    private:
-      transaction               t_;
-      transaction*              ct_; // Current transaction.
-      unique_ptr<database_type> db_;
-    };
-
-    // Show how we got here (used for both info and text).
-    //
-    auto add_info = [&dep, &dependents, &origin_cfgs] (const basic_mark& bm)
+    auto add_info = [&dep, &dependents, &origin_cfgs] (const basic_mark& bm)
     {
       const dependent& dpt (dependents[0]);
 
@@ -886,6 +1161,347 @@ namespace bdep
     return exists (p);
   }
 
+  // Synchronization fingerprint.
+  //
+  // After a successful synchronization we save in the project database (for
+  // each origin configuration) the checksum of the configuration's path and
+  // initialized packages as well as of the modification times of the
+  // filesystem entries that determine the synchronization outcome: the
+  // packages.manifest and repositories.manifest files of each involved
+  // project, package manifests and build system bootstrap/root files of the
+  // initialized packages, git HEAD and index of the enclosing repository,
+  // and the bpkg databases of the entire configuration cluster.
+  //
+  // The list of entries as well as the cluster directories are saved
+  // alongside so that an implicit synchronization can recalculate and
+  // compare the checksum without running any external programs. If it
+  // matches, then nothing has changed since the last synchronization and we
+  // skip it.
+  //
+  // Note that changes not reflected in these entries (for example,
+  // uncommitted changes that only affect a package snapshot version) will
+  // be picked up by the next explicit (or otherwise non-noop) sync.
+  //
+  static string
+  sync_fingerprint (const configuration& c, const paths& ps)
+  {
+    strings ss {c.path.string (), c.forward ? "forward" : "no-forward"};
+
+    for (const package_state& p: c.packages)
+      ss.push_back (p.name.string ());
+
+    return sync_checksum (ss, ps);
+  }
+
+  // Return the sorted list of filesystem entries that determine the outcome
+  // of synchronizing the specified projects in the specified cluster.
+  //
+  static paths
+  sync_fingerprint_paths (const sync_projects& prjs,
+                          const linked_configs& lcfgs)
+  {
+    paths r;
+
+    for (const sync_project& prj: prjs)
+    {
+      const dir_path& pd (prj.path);
+
+      r.push_back (pd / packages_file);
+      r.push_back (pd / repositories_file);
+
+      for (path& p: git_state_files (pd))
+        r.push_back (move (p));
+
+      package_locations pls (load_packages (pd));
+
+      for (const sync_project::config& cfg: prj.configs)
+      {
+        for (const package_state& pkg: cfg->packages)
+        {
+          auto i (find_if (pls.begin (), pls.end (),
+                           [&pkg] (const package_location& pl)
+                           {
+                             return pkg.name == pl.name;
+                           }));
+
+          if (i == pls.end ())
+            continue;
+
+          dir_path d (pd / i->path);
+
+          r.push_back (d / manifest_file);
+
+          for (const char* f: {"build/bootstrap.build",
+                               "build/root.build",
+                               "build2/bootstrap.build2",
+                               "build2/root.build2"})
+            r.push_back (d / path (f));
+        }
+      }
+    }
+
+    // Note that bpkg may not have checkpointed the WAL file into the
+    // database yet.
+    //
+    for (const linked_config& cfg: lcfgs)
+    {
+      path f (cfg.path / bpkg_file);
+      r.push_back (f);
+      r.push_back (move (f += "-wal"));
+    }
+
+    sort (r.begin (), r.end ());
+    r.erase (unique (r.begin (), r.end ()), r.end ());
+
+    return r;
+  }
+
+  // Return true if the configuration's synchronization fingerprint matches
+  // its current state. Load the fingerprint from the project database, if
+  // not already loaded, reusing the transaction if specified.
+  //
+  static bool
+  sync_fingerprint_match (const common_options& co,
+                          const dir_path& prj,
+                          configuration& c,
+                          transaction* origin_tr,
+                          tracer& trace)
+  {
+    if (!c.sync_section.loaded ())
+    {
+      database_transaction t (origin_tr, prj, co.sqlite_synchronous (), trace);
+      t.database ().load (c, c.sync_section);
+      t.commit ();
+    }
+
+    return c.sync_fingerprint &&
+           *c.sync_fingerprint == sync_fingerprint (c, c.sync_paths);
+  }
+
+  // Save the synchronization fingerprint for the origin configurations.
+  //
+  static void
+  save_sync_fingerprint (const common_options& co,
+                         const dir_path& prj,
+                         const sync_configs& cfgs,
+                         const linked_configs& lcfgs,
+                         const paths& ps,
+                         transaction* origin_tr,
+                         tracer& trace)
+  {
+    dir_paths cl;
+    vector<cluster_config> cc;
+    for (const linked_config& cfg: lcfgs)
+    {
+      cl.push_back (cfg.path);
+      cc.push_back (cluster_config {cfg.path,
+                                    cfg.uuid.string (),
+                                    cfg.fetch_cache_mode});
+    }
+
+    string cs (cluster_stamp (lcfgs));
+
+    database_transaction t (origin_tr, prj, co.sqlite_synchronous (), trace);
+    database& db (t.database ());
+
+    for (const sync_config& sc: cfgs)
+    {
+      configuration& c (*sc);
+
+      if (!c.sync_section.loaded ())
+        db.load (c, c.sync_section);
+
+      c.sync_fingerprint = sync_fingerprint (c, ps);
+      c.sync_cluster = cl;
+      c.sync_paths = ps;
+
+      // Since the sync has most likely changed the bpkg databases, also
+      // refresh the cluster cache stamp (see find_config_cluster()).
+      //
+      c.cluster = cc;
+      c.cluster_stamp = cs;
+
+      db.update (c, c.sync_section);
+    }
+
+    t.commit ();
+  }
+
+  // Write the auto-synchronization build system hook into the specified
+  // configuration, unless it is already up to date.
+  //
+  // Besides running bdep-sync, the hook (protocol 2) contains the stamp,
+  // that is, the checksum of the configuration directory and of the
+  // modification times of the filesystem entries that determine the
+  // synchronization outcome (see sync_fingerprint_paths()), followed by the
+  // list of such entries. In this mode bdep-sync verifies the stamp before
+  // doing anything else (opening databases, running bpkg, etc) and exits
+  // immediately if it matches.
+  //
+  // Note, however, that the stamp cannot be verified by the hook itself
+  // since the build system has no means of obtaining the modification times.
+  // As a result, a plain build system invocation still starts bdep-sync on
+  // every build, which in the "everything is already synchronized" case
+  // boils down to reading the hook and a few stat() calls (but still costs
+  // the process startup).
+  //
+  // We can, however, avoid starting bdep if the configuration is listed in
+  // BDEP_SYNCED_CONFIGS (the build is performed by a bdep command, such as
+  // update or test, which has already synchronized it) or BPKG_OPEN_CONFIGS
+  // (the build is performed by bpkg which has the databases open), since
+  // bdep-sync would do nothing in these cases anyway. To check that without
+  // setting any variables we embed the configuration directory into the
+  // hook as a quoted literal (in the same form as it appears in these
+  // variables; see contains()).
+  //
+  // If refresh is true, then we are only updating the stamp in the existing
+  // hook and ignore errors (the worst that can happen is an extra sync; on
+  // Windows the hook can be open by the build system that triggered this
+  // sync).
+  //
+  static void
+  write_hook (const dir_path& cfg, const paths& ps, bool refresh)
+  {
+    path f (cfg / hook_file);
+
+    // Note that we try to avoid setting any variables in order not to
+    // pollute the configuration's root scope.
+    //
+    ostringstream os;
+
+    os << "# Created automatically by bdep."                          << '\n'
+       << "#"                                                         << '\n'
+       << "# bdep-sync-stamp: " << sync_checksum ({cfg.string ()}, ps)
+                                                                      << '\n';
+
+    for (const path& p: ps)
+      os << "# bdep-sync-entry: " << p.string ()                      << '\n';
+
+    os << "#"                                                         << '\n'
+       << "if ($build.meta_operation != 'info'      && \\"            << '\n'
+       << "    $build.meta_operation != 'configure' && \\"            << '\n'
+       << "    $build.meta_operation != 'disfigure')"                 << '\n'
+       << "{"                                                         << '\n'
+       << "  if (($getenv('BDEP_SYNC') == [null] || \\"               << '\n'
+       << "       $getenv('BDEP_SYNC') == true   || \\"               << '\n'
+       << "       $getenv('BDEP_SYNC') == 1)";
+
+    // We can only represent the configuration directory as a single-quoted
+    // literal if it doesn't contain single quotes. In the unlikely case it
+    // does, we just always start bdep-sync.
+    //
+    if (cfg.string ().find ('\'') == string::npos)
+    {
+#ifndef _WIN32
+      const char* flags ("");
+#else
+      const char* flags (", icase");
+#endif
+      const string d ("'\"" + cfg.string () + "\"'");
+
+      for (const char* v: {"BDEP_SYNCED_CONFIGS", "BPKG_OPEN_CONFIGS"})
+      {
+        os << " && \\"                                                << '\n'
+           << "      ($getenv('" << v << "') == [null] || \\"         << '\n'
+           << "       !$string.contains($getenv('" << v << "'), "
+           << d << flags << "))";
+      }
+    }
+
+    os << ')'                                                         << '\n'
+       << "    run '" << argv0 << "' sync --hook=2 "                  <<
+      "--verbose $build.verbosity "                                   <<
+      "($build.progress == [null] ? : $build.progress ? --progress : --no-progress) " <<
+      "($build.diag_color == [null] ? : $build.diag_color ? --diag-color : --no-diag-color) " <<
+      "--config \"$out_root\""                                        << '\n'
+       << "}"                                                         << '\n';
+
+    string c (os.str ());
+
+    // Don't touch the hook if it is already up to date. Besides saving the
+    // write, this also keeps the hook of every configuration in the cluster
+    // from being rewritten on every sync.
+    //
+    try
+    {
+      if (exists (f))
+      {
+        ifdstream is (f);
+        if (is.read_text () == c)
+          return;
+      }
+    }
+    catch (const io_error&)
+    {
+      // Assume out of date.
+    }
+
+    path t (f); t += ".tmp";
+
+    if (!refresh)
+      mk (f.directory ());
+
+    try
+    {
+      auto_rmfile rmt (t);
+
+      ofdstream os (t);
+      os << c;
+      os.close ();
+
+      butl::mvfile (t, f);
+      rmt.cancel ();
+    }
+    catch (const io_error& e)
+    {
+      if (!refresh)
+        fail << "unable to write to " << t << ": " << e;
+    }
+    catch (const system_error& e)
+    {
+      if (!refresh)
+        fail << "unable to move " << t << " to " << f << ": " << e;
+    }
+  }
+
+  // Return true if the stamp in the configuration's build system hook
+  // matches its current state (see write_hook() for details).
+  //
+  static bool
+  hook_stamp_match (const dir_path& cfg)
+  {
+    path f (cfg / hook_file);
+
+    optional<string> stamp;
+    paths ps;
+
+    try
+    {
+      ifdstream is (f, ifdstream::badbit);
+
+      // Note that the stamp comment lines are all at the beginning of the
+      // file.
+      //
+      for (string l; !eof (getline (is, l)) && l.compare (0, 1, "#") == 0; )
+      {
+        if (l.compare (0, 19, "# bdep-sync-stamp: ") == 0)
+          stamp = string (l, 19);
+        else if (l.compare (0, 19, "# bdep-sync-entry: ") == 0)
+          ps.push_back (path (string (l, 19)));
+      }
+    }
+    catch (const io_error&)
+    {
+      return false; // Let the full sync deal with it.
+    }
+    catch (const invalid_path&)
+    {
+      return false;
+    }
+
+    return stamp && *stamp == sync_checksum ({cfg.string ()}, ps);
+  }
+
   // Sync with optional upgrade.
   //
   // If upgrade is not nullopt, then: If there are dep_pkgs, then we are
@@ -905,6 +1521,13 @@ namespace bdep
     strings                           reps;
   };
 
+  struct fetch_project // Ditto.
+  {
+    reference_wrapper<const sync_project> project;
+    string                                stamp;
+    configurations                        configs;
+  };
+
   static void
   cmd_sync (const common_options& co,
             const dir_path& origin_prj,
@@ -976,11 +1599,7 @@ namespace bdep
     // Note that this may add more (implicit) configurations to origin_prj's
     // entry.
     //
-    // @@ We may end up openning the database (in load_implicit()) for each
-    //    project multiple times.
-    //
-    for (const linked_config& cfg: linked_cfgs)
-      load_implicit (co, cfg.path, prjs, origin_prj, origin_tr);
+    load_implicit (co, linked_cfgs, prjs, origin_prj, origin_tr);
 
     // Verify that no initialized package in any of the projects sharing this
     // configuration is specified as a dependency.
@@ -1622,7 +2241,11 @@ namespace bdep
                                        transaction::current (*ct);
                                    }));
 
-              database db (open (pd, co.sqlite_synchronous (), trace));
+              database db (open (pd,
+                                 co.sqlite_synchronous (),
+                                 trace,
+                                 false /* create */,
+                                 true  /* shared */));
               transaction t (db.begin ());
               lookup (db);
               t.commit ();
@@ -1717,95 +2340,336 @@ namespace bdep
     //    "synchronizing <cfg-dir>:". Maybe rep-fetch also needs something
     //    like --plan but for progress? Plus there might be no sync at all.
     //
-    for (const config& cfg: cfgs)
+    // Note: counter-intuitively, we may end up here even if fetch is
+    // nullopt; see load_implicit() for details.
+    //
+    bool deep_fetch (fetch && *fetch);
+
+    // Skip fetching the project repositories already or recently fetched in
+    // (see fetch_skip() for details) and collect the configurations we fetch
+    // them in to save the fetch information after the successful fetch.
+    //
+    small_vector<fetch_project, 1> fprjs;
+
+    fetch_depth fdepth (deep_fetch ? fetch_depth::deep : fetch_depth::shallow);
+    timestamp fstart (std::chrono::system_clock::now ());
+
+    size_t fjobs (
+      co.fetch_jobs () != 0 ? co.fetch_jobs () : hardware_concurrency ());
+
+    for (const sync_project& prj: prjs)
     {
-      if (cfg.reps.empty ())
+      configurations fcs;
+      for (const sync_project::config& cfg: prj.configs)
+      {
+        if (cfg.fetch && !cfg->packages.empty ())
+          fcs.push_back (cfg);
+      }
+
+      if (fcs.empty ())
         continue;
 
-      const path& p (cfg.path);
+      string stamp (fetch_stamp (co, prj.path));
 
-      // If we are deep-fetching multiple configurations, print their names.
-      // Failed that it will be quite confusing since we may be re-fetching
-      // the same repositories over and over.
-      //
-      // Note: counter-intuitively, we may end up here even if fetch is
-      // nullopt; see load_implicit() for details.
+      // If we may fetch concurrently, then we will need the cached clusters
+      // to determine which configurations are linked (see below).
       //
-      bool deep_fetch (fetch && *fetch);
+      bool load_clusters (false);
+      if (fjobs > 1)
+      {
+        for (const shared_ptr<configuration>& c: fcs)
+        {
+          if (!c->sync_section.loaded ())
+          {
+            load_clusters = true;
+            break;
+          }
+        }
+      }
 
-      if (cfgs.size () != 1 && deep_fetch)
-        text << "fetching in configuration " << p.representation ();
+      if (co.fetch_max_age_specified () || load_clusters)
+      {
+        database_transaction t (prj.path == origin_prj ? origin_tr : nullptr,
+                                prj.path,
+                                co.sqlite_synchronous (),
+                                trace);
 
-      run_bpkg (bpkg_fetch_verb, co,
-                "fetch",
-                "-d", p,
-                (deep_fetch ? nullptr : "--shallow"),
-                "--no-dir-progress",
-                cfg.reps);
-    }
+        database& db (t.database ());
 
-    string plan;
-    if (name_cfg)
-    {
-      for (const sync_config& cfg: origin_cfgs)
-      {
-        if (!plan.empty ())
-          plan += ",\n";
+        load_fetch_info (co, db, fcs);
 
-        plan += "synchronizing ";
+        if (load_clusters)
+        {
+          for (const shared_ptr<configuration>& c: fcs)
+          {
+            if (!c->sync_section.loaded ())
+              db.load (*c, c->sync_section);
+          }
+        }
 
-        // Use name if available, directory otherwise.
-        //
-        if (cfg != nullptr && cfg->name)
+        t.commit ();
+      }
+
+      string rep (repository_name (prj.path));
+
+      for (auto i (fcs.begin ()); i != fcs.end (); )
+      {
+        if (fetch_skip (co, prj.path, **i, fdepth, stamp))
         {
-          plan += '@';
-          plan += *cfg->name;
+          const dir_path& d ((*i)->path);
+
+          auto j (find_if (cfgs.begin (), cfgs.end (),
+                           [&d] (const config& c)
+                           {
+                             return c.path.get () == d;
+                           }));
+
+          assert (j != cfgs.end ());
+
+          strings& rs (j->reps);
+          rs.erase (find (rs.begin (), rs.end (), rep));
+
+          l4 ([&]{trace << "skipping fetched " << rep << " in " << d;});
+
+          i = fcs.erase (i);
         }
         else
-          plan += cfg.path ().representation ();
+          ++i;
       }
 
-      plan += ':';
+      if (!fcs.empty ())
+        fprjs.push_back (fetch_project {prj, move (stamp), move (fcs)});
     }
-    else
-      plan = "synchronizing:";
 
-    // Now configure the requested packages, preventing bpkg-pkg-build from
-    // creating private configurations for build-time dependencies and
-    // providing them ourselves on demand.
-    //
-    // Specifically, if the build-time dependency configuration needs to be
-    // provided, then the plan is as follows:
-    //
-    // 1. Select a project which we can use as a "source" of the build-time
-    //    dependency configuration: use its associated configuration of a
-    //    suitable type, if exist, or create a new one using this project's
-    //    name as a stem.
-    //
-    //    Such a project needs to have the immediate dependent configuration
-    //    associated and contain a source directory of some of the dependents,
-    //    not necessary immediate but the closer to the dependency the better.
-    //    Not being able to find such a project is an error.
-    //
-    // 2. If the "source" project already has a default configuration of the
-    //    suitable type associated, then use that. Otherwise, if the project
-    //    has a single configuration of the suitable type associated, then use
-    //    that. Otherwise, if the project has no suitable configuration
-    //    associated, then create it. Fail if multiple such configurations are
-    //    associated.
-    //
-    // 3. If the dependency configuration needs to be created then perform the
-    //    following steps:
+    // Fetch in multiple configurations concurrently (see --fetch-jobs for
+    // details). Note that bpkg attaches the databases of the configurations
+    // linked with the one being fetched in, locking them exclusively. So we
+    // only fetch concurrently in configurations that are not linked with
+    // each other, according to the clusters cached in the project databases
+    // (see unlinked_waves() for details), and serially otherwise (which is
+    // also the default; see --fetch-jobs).
     //
-    //    - Confirm with the user the list of commands as-if to be executed,
-    //      unless the respective create_*_config argument is true.
-    //
-    //    - Create the configuration.
+    // If fetching deep, then we first fetch in the configurations that are
+    // the first to fetch some repository so that the rest can reuse the
+    // prerequisite and complement repositories from the fetch cache (see
+    // fetch_waves() for details).
     //
-    //    - Associate the created configuration with the "source" project and
-    //      all other projects, which should have no configurations of this
-    //      type associated (fail if that's not the case before creating
-    //      anything).
+    {
+      small_vector<reference_wrapper<const config>, 16> fcfgs;
+
+      for (const config& cfg: cfgs)
+      {
+        if (!cfg.reps.empty ())
+          fcfgs.push_back (cfg);
+      }
+
+      size_t jobs (fcfgs.size () > 1 ? fjobs : 1);
+
+      vector<size_t> order;
+      size_t first (fcfgs.size ());
+
+      if (deep_fetch && jobs > 1)
+      {
+        vector<strings> reps;
+        for (const config& cfg: fcfgs)
+          reps.push_back (cfg.reps);
+
+        pair<vector<size_t>, size_t> ws (fetch_waves (co, reps));
+
+        order = move (ws.first);
+        first = ws.second;
+      }
+      else
+      {
+        for (size_t i (0); i != fcfgs.size (); ++i)
+          order.push_back (i);
+      }
+
+      // Return the configuration object for the configuration directory
+      // (with the cached cluster loaded; see above) or NULL if there is
+      // none.
+      //
+      auto find_config = [&fprjs] (const dir_path& d) -> const configuration*
+      {
+        for (const fetch_project& fp: fprjs)
+        {
+          for (const shared_ptr<configuration>& c: fp.configs)
+          {
+            if (c->path == d && c->sync_section.loaded ())
+              return c.get ();
+          }
+        }
+
+        return nullptr;
+      };
+
+      auto fetch = [&co, &cfgs, &fcfgs, &order, &find_config, jobs,
+                    bpkg_fetch_verb, deep_fetch] (size_t b, size_t e)
+      {
+        // Split the configurations into waves of unlinked configurations,
+        // falling back to a single (serial) wave if the cached cluster is
+        // not available for any of them.
+        //
+        vector<vector<size_t>> ws;
+
+        if (jobs > 1 && e - b > 1)
+        {
+          vector<reference_wrapper<const configuration>> cs;
+
+          for (size_t i (b); i != e; ++i)
+          {
+            const configuration* c (
+              find_config (fcfgs[order[i]].get ().path.get ()));
+
+            if (c == nullptr)
+              break;
+
+            cs.push_back (*c);
+          }
+
+          if (cs.size () == e - b)
+            ws = unlinked_waves (cs);
+        }
+
+        size_t n (jobs);
+        if (ws.empty ())
+        {
+          ws.push_back (vector<size_t> ());
+          for (size_t i (0); i != e - b; ++i)
+            ws.back ().push_back (i);
+
+          n = 1;
+        }
+
+        for (const vector<size_t>& w: ws)
+        {
+          run_concurrently (
+            n,
+            w.size (),
+            [&cfgs, &fcfgs, &order, &w, b, deep_fetch] (size_t i)
+            {
+              // If we are deep-fetching multiple configurations, print their
+              // names. Failed that it will be quite confusing since we may
+              // be re-fetching the same repositories over and over.
+              //
+              if (cfgs.size () != 1 && deep_fetch)
+              {
+                const config& cfg (fcfgs[order[b + w[i]]]);
+
+                text << "fetching in configuration "
+                     << cfg.path.get ().representation ();
+              }
+            },
+            [&co, &fcfgs, &order, &w, b, bpkg_fetch_verb, deep_fetch] (
+              size_t i, int out, int err)
+            {
+              const config& cfg (fcfgs[order[b + w[i]]]);
+
+              return start_bpkg (bpkg_fetch_verb, co,
+                                 out,
+                                 err,
+                                 "fetch",
+                                 "-d", cfg.path.get (),
+                                 (deep_fetch ? nullptr : "--shallow"),
+                                 "--no-dir-progress",
+                                 cfg.reps);
+            },
+            [&co] (size_t, process& pr)
+            {
+              finish_bpkg (co, pr);
+            });
+        }
+      };
+
+      fetch (0, first);
+      fetch (first, order.size ());
+    }
+
+    for (const fetch_project& fp: fprjs)
+    {
+      const dir_path& d (fp.project.get ().path);
+
+      for (const shared_ptr<configuration>& c: fp.configs)
+        fetch_performed (d, *c, fdepth);
+
+      if (co.fetch_max_age_specified ())
+      {
+        database_transaction t (d == origin_prj ? origin_tr : nullptr,
+                                d,
+                                co.sqlite_synchronous (),
+                                trace);
+
+        database& db (t.database ());
+
+        for (const shared_ptr<configuration>& c: fp.configs)
+          save_fetch_info (co, db, *c, fdepth, fp.stamp, fstart);
+
+        t.commit ();
+      }
+    }
+
+    string plan;
+    if (name_cfg)
+    {
+      for (const sync_config& cfg: origin_cfgs)
+      {
+        if (!plan.empty ())
+          plan += ",\n";
+
+        plan += "synchronizing ";
+
+        // Use name if available, directory otherwise.
+        //
+        if (cfg != nullptr && cfg->name)
+        {
+          plan += '@';
+          plan += *cfg->name;
+        }
+        else
+          plan += cfg.path ().representation ();
+      }
+
+      plan += ':';
+    }
+    else
+      plan = "synchronizing:";
+
+    // Now configure the requested packages, preventing bpkg-pkg-build from
+    // creating private configurations for build-time dependencies and
+    // providing them ourselves on demand.
+    //
+    // Specifically, if the build-time dependency configuration needs to be
+    // provided, then the plan is as follows:
+    //
+    // 1. Select a project which we can use as a "source" of the build-time
+    //    dependency configuration: use its associated configuration of a
+    //    suitable type, if exist, or create a new one using this project's
+    //    name as a stem.
+    //
+    //    Such a project needs to have the immediate dependent configuration
+    //    associated and contain a source directory of some of the dependents,
+    //    not necessary immediate but the closer to the dependency the better.
+    //    Not being able to find such a project is an error.
+    //
+    // 2. If the "source" project already has a default configuration of the
+    //    suitable type associated, then use that. Otherwise, if the project
+    //    has a single configuration of the suitable type associated, then use
+    //    that. Otherwise, if the project has no suitable configuration
+    //    associated, then create it. Fail if multiple such configurations are
+    //    associated.
+    //
+    // 3. If the dependency configuration needs to be created then perform the
+    //    following steps:
+    //
+    //    - Confirm with the user the list of commands as-if to be executed,
+    //      unless the respective create_*_config argument is true.
+    //
+    //    - Create the configuration.
+    //
+    //    - Associate the created configuration with the "source" project and
+    //      all other projects, which should have no configurations of this
+    //      type associated (fail if that's not the case before creating
+    //      anything).
     //
     // 4. Link the immediate dependent configuration with the dependency
     //    configuration (either found via the "source" project or newly
@@ -1815,6 +2679,7 @@ namespace bdep
     //    dependency configuration is required, then go to p.1.
     //
     bool noop (false);
+    bool linked (false); // Linked a dependency configuration.
     for (;;)
     {
       // Run bpkg with the --no-private-config option, so that it reports the
@@ -1938,6 +2803,13 @@ namespace bdep
                               origin_tr,
                               created_cfgs,
                               trace);
+      linked = true;
+
+      // The cluster has changed so drop the cached bpkg information for
+      // good measure.
+      //
+      config_cluster_cache.clear ();
+      repository_dirs_cache.clear ();
     }
 
     // Handle configuration forwarding.
@@ -1951,8 +2823,14 @@ namespace bdep
     // implemented by just changing the flag on the configuration and then
     // requiring an explicit sync to configure/disfigure forwards.
     //
+    // Note that we collect the src/out pairs of all the packages and
+    // configure (disfigure) them with a single build system invocation.
+    //
     if (!implicit || !noop)
     {
+      vector<pair<dir_path, dir_path>> configure_fwds;
+      vector<pair<dir_path, dir_path>> disfigure_fwds;
+
       for (const sync_project& prj: prjs)
       {
         package_locations pls (load_packages (prj.path));
@@ -1980,10 +2858,10 @@ namespace bdep
               src /= i->path;
             }
 
-            const char* o (nullptr);
+            vector<pair<dir_path, dir_path>>* fs (nullptr);
             if (cfg->forward)
             {
-              o = "configure:";
+              fs = &configure_fwds;
             }
             else if (!cfg.implicit) // Requires explicit sync.
             {
@@ -1992,30 +2870,23 @@ namespace bdep
               //   is to this config. 'b info' here we come?
 #if 0
               if (exists (src, path ("bootstrap") /= "out-root.build"))
-                o = "disfigure:";
+                fs = &disfigure_fwds;
 #endif
             }
 
-            if (o != nullptr)
-            {
-              dir_path out (dir_path (cfg->path) /= pkg.name.string ());
-
-              // Note that --no-external-modules makes a difference for
-              // developing build system modules that require bootstrapping
-              // (which without that option would trigger a recursive sync).
-              //
-              run_b (
-                co,
-                "--no-external-modules",
-                o,
-                '\'' + src.representation () + "'@'" + out.representation () +
-                "',forward");
-            }
+            if (fs != nullptr)
+              fs->emplace_back (move (src),
+                                dir_path (cfg->path) /= pkg.name.string ());
           }
         }
       }
+
+      run_b_forward (co, "configure", configure_fwds);
+      run_b_forward (co, "disfigure", disfigure_fwds);
     }
 
+    paths ps (sync_fingerprint_paths (prjs, linked_cfgs));
+
     // Add/remove auto-synchronization build system hook.
     //
     // It feels right to only do this for origin_cfgs (remember, we require
@@ -2025,63 +2896,48 @@ namespace bdep
     {
       for (const sync_config& cfg: origin_cfgs)
       {
-        path f (cfg->path / hook_file);
-        bool e (exists (f));
-
         if (cfg->auto_sync)
-        {
-          if (!e)
-          {
-            mk (f.directory ());
-
-            try
-            {
-              ofdstream os (f);
-
-              // Should we analyze BDEP_SYNCED_CONFIGS ourselves or should we
-              // let bdep-sync do it for us? Doing it here instead of spawning
-              // a process (which will load the database, etc) will be faster.
-              // But, on the other hand, this is only an issue for commands
-              // like update and test that do their own implicit sync.
-              //
-              // cfgs = $getenv(BDEP_SYNCED_CONFIGS)
-              // if! $null($cfgs)
-              //   cfgs = [dir_paths] $regex.split($cfgs, ' *"([^"]*)" *', '\1')
-              //
-              // Also note that we try to avoid setting any variables in order
-              // not to pollute the configuration's root scope.
-              //
-              os << "# Created automatically by bdep."                 << endl
-                 << "#"                                                << endl
-                 << "if ($build.meta_operation != 'info'      && \\"   << endl
-                 << "    $build.meta_operation != 'configure' && \\"   << endl
-                 << "    $build.meta_operation != 'disfigure')"        << endl
-                 << "{"                                                << endl
-                 << "  if ($getenv('BDEP_SYNC') == [null] || \\"       << endl
-                 << "      $getenv('BDEP_SYNC') == true   || \\"       << endl
-                 << "      $getenv('BDEP_SYNC') == 1)"                 << endl
-                 << "    run '" << argv0 << "' sync --hook=1 "         <<
-                "--verbose $build.verbosity "                          <<
-                "($build.progress == [null] ? : $build.progress ? --progress : --no-progress) " <<
-                "($build.diag_color == [null] ? : $build.diag_color ? --diag-color : --no-diag-color) " <<
-                "--config \"$out_root\""                               << endl
-                 << "}"                                                << endl;
-
-              os.close ();
-            }
-            catch (const io_error& e)
-            {
-              fail << "unable to write to " << f << ": " << e;
-            }
-          }
-        }
+          write_hook (cfg->path, ps, false /* refresh */);
         else
         {
-          if (e)
+          path f (cfg->path / hook_file);
+
+          if (exists (f))
             rm (f);
         }
       }
     }
+
+    // Refresh the stamp in the existing hooks of the rest of the cluster.
+    //
+    for (const linked_config& cfg: linked_cfgs)
+    {
+      if (origin && !implicit &&
+          find_if (origin_cfgs.begin (), origin_cfgs.end (),
+                   [&cfg] (const sync_config& c)
+                   {
+                     return c.path () == cfg.path;
+                   }) != origin_cfgs.end ())
+        continue;
+
+      if (exists (cfg.path / hook_file))
+        write_hook (cfg.path, ps, true /* refresh */);
+    }
+
+    // Save the synchronization fingerprint so that subsequent implicit
+    // syncs can be skipped if nothing has changed. Note that we don't bother
+    // in the deinit mode since the packages are no longer initialized. We
+    // also don't bother if we have linked any configurations since then the
+    // cluster has changed.
+    //
+    if (origin && deinit_pkgs.empty () && !linked)
+      save_sync_fingerprint (co,
+                             origin_prj,
+                             origin_cfgs,
+                             linked_cfgs,
+                             ps,
+                             origin_tr,
+                             trace);
   }
 
   // Return true if a space-separated list of double-quoted paths contains the
@@ -2165,106 +3021,350 @@ namespace bdep
     return false;
   }
 
-  // Given the configuration directory, return absolute and normalized
-  // directories and UUIDs of the entire linked configuration cluster.
+  // As above but for a configuration of the specified project, reusing the
+  // cluster cached in the project database if it is still valid, that is, if
+  // none of the cluster members' bpkg databases have changed since it was
+  // cached. Query and cache the cluster otherwise or if --refresh-cluster is
+  // specified.
   //
   static linked_configs
-  find_config_cluster (const common_options& co, const dir_path& d)
+  find_config_cluster (const common_options& co,
+                       const dir_path& prj,
+                       configuration& c,
+                       transaction* origin_tr,
+                       tracer& trace)
   {
-    linked_configs r;
+    if (!c.sync_section.loaded ())
+    {
+      database_transaction t (origin_tr, prj, co.sqlite_synchronous (), trace);
+      t.database ().load (c, c.sync_section);
+      t.commit ();
+    }
 
-    // Run bpkg-cfg-info to get the list of linked configurations.
-    //
-    fdpipe pipe (open_pipe ()); // Text mode seems appropriate.
+    if (!co.refresh_cluster () && c.cluster_stamp && !c.cluster.empty ())
+    {
+      linked_configs r;
 
-    process pr (start_bpkg (3,
-                            co,
-                            pipe /* stdout */,
-                            2    /* stderr */,
-                            "cfg-info",
-                            "-d", d,
-                            "--link",
-                            "--backlink",
-                            "--recursive"));
+      try
+      {
+        for (const cluster_config& cc: c.cluster)
+          r.push_back (
+            linked_config {cc.path, uuid (cc.uuid), cc.fetch_cache_mode});
+      }
+      catch (const invalid_argument&)
+      {
+        r.clear (); // Re-query.
+      }
 
-    pipe.out.close (); // Shouldn't throw unless very broken.
+      if (!r.empty ()                &&
+          r.front ().path == c.path  &&
+          cluster_stamp (r) == *c.cluster_stamp)
+      {
+        // Make it available to find_config_cluster(dir_path) as well (see
+        // find_fetch_cache_mode() for details).
+        //
+        cache_config_cluster (r, *c.cluster_stamp);
+        return r;
+      }
+    }
 
-    bool io (false);
+    linked_configs r (find_config_cluster (co, c.path));
+
+    c.cluster.clear ();
+    for (const linked_config& cfg: r)
+      c.cluster.push_back (cluster_config {cfg.path,
+                                           cfg.uuid.string (),
+                                           cfg.fetch_cache_mode});
+
+    c.cluster_stamp = cluster_stamp (r);
+
+    database_transaction t (origin_tr, prj, co.sqlite_synchronous (), trace);
+    t.database ().update (c, c.sync_section);
+    t.commit ();
+
+    return r;
+  }
+
+  // Concurrent synchronization of independent linked configuration clusters
+  // (see --sync-jobs for details).
+  //
+  // Since the synchronization involves interactions with bpkg, the build
+  // system, and the project databases, we synchronize each cluster in a
+  // separate bdep-sync process, as if its originating configurations were
+  // specified on the command line. Such a process is marked as a job via the
+  // BDEP_SYNC_JOB environment variable (see sync_job in utility.hxx), in
+  // which case it uses its own temporary directory and leaves printing the
+  // configuration header to us.
+  //
+  // Since the project databases can be used by its siblings for a short
+  // while, we also pass --lock-wait (60 seconds, unless specified).
+  //
+  static const char sync_job_var[] = "BDEP_SYNC_JOB";
+
+  // Return the maximum number of clusters to synchronize concurrently.
+  //
+  static inline size_t
+  sync_jobs (const common_options& co)
+  {
+    return co.sync_jobs () != 0 ? co.sync_jobs () : hardware_concurrency ();
+  }
+
+  // Return the bdep-sync options corresponding to the system package
+  // options.
+  //
+  static strings
+  sys_ops (const sys_options& so)
+  {
+    strings r;
+
+    if (so.no_query) r.push_back ("--sys-no-query");
+    if (so.install)  r.push_back ("--sys-install");
+    if (so.no_fetch) r.push_back ("--sys-no-fetch");
+    if (so.no_stub)  r.push_back ("--sys-no-stub");
+    if (so.yes)      r.push_back ("--sys-yes");
+
+    if (so.sudo)
+    {
+      r.push_back ("--sys-sudo");
+      r.push_back (*so.sudo);
+    }
+
+    return r;
+  }
+
+  // Synchronize the specified clusters (represented by their originating
+  // configurations) concurrently, passing the specified additional options
+  // to each bdep-sync process, and print the combined summary.
+  //
+  // Note that the caller is expected to have already marked the clusters as
+  // synchronized in BDEP_SYNCED_CONFIGS. The processes, however, get its
+  // original (specified) value, so that they don't skip their own cluster.
+  //
+  static void
+  sync_clusters (const common_options& co,
+                 const dir_path& prj,
+                 const vector<sync_configs>& clusters,
+                 const optional<string>& synced_cfgs,
+                 const strings& ops,
+                 const function<void (size_t)>& intro)
+  {
+    size_t n (clusters.size ());
+
+    process_path pp;
     try
     {
-      ifdstream is (move (pipe.in), fdstream_mode::skip, ifdstream::badbit);
+      pp = process::path_search (argv0, true /* init */);
+    }
+    catch (const process_error& e)
+    {
+      fail << "unable to execute " << argv0 << ": " << e;
+    }
 
-      string l; // Reuse the buffer.
-      do
+    // Forward our common options. Note that the default options files have
+    // already been merged into them.
+    //
+    // Note also that the options are forwarded explicitly, one by one, since
+    // there is no way to serialize them back into the command line. The
+    // following options are not forwarded: -v, -V, and --quiet (represented
+    // by --verbose), --stdout-format, --jobs, --pager*, and --fetch-stats
+    // (don't affect synchronization), --sync-jobs (the jobs don't spawn jobs
+    // of their own), and --options-file and --*default-options* (already
+    // merged). Any other (including newly added) option must be forwarded
+    // here and the sync-jobs test in sync.testscript extended accordingly.
+    //
+    strings cops {"--no-default-options", "--verbose", to_string (verb)};
+
+    if (co.progress ())      cops.push_back ("--progress");
+    if (co.no_progress ())   cops.push_back ("--no-progress");
+    if (co.diag_color ())    cops.push_back ("--diag-color");
+    if (co.no_diag_color ()) cops.push_back ("--no-diag-color");
+
+    if (co.bpkg_specified ())
+    {
+      cops.push_back ("--bpkg");
+      cops.push_back (co.bpkg ().string ());
+    }
+
+    for (const string& o: co.bpkg_option ())
+    {
+      cops.push_back ("--bpkg-option");
+      cops.push_back (o);
+    }
+
+    if (co.build_specified ())
+    {
+      cops.push_back ("--build");
+      cops.push_back (co.build ().string ());
+    }
+
+    for (const string& o: co.build_option ())
+    {
+      cops.push_back ("--build-option");
+      cops.push_back (o);
+    }
+
+    if (co.curl_specified ())
+    {
+      cops.push_back ("--curl");
+      cops.push_back (co.curl ().string ());
+    }
+
+    for (const string& o: co.curl_option ())
+    {
+      cops.push_back ("--curl-option");
+      cops.push_back (o);
+    }
+
+    if (co.offline ())        cops.push_back ("--offline");
+    if (co.no_fetch_cache ()) cops.push_back ("--no-fetch-cache");
+
+    if (co.fetch_cache_specified ())
+    {
+      cops.push_back ("--fetch-cache");
+      cops.push_back (co.fetch_cache ());
+    }
+
+    if (co.fetch_cache_session_specified ())
+    {
+      cops.push_back ("--fetch-cache-session");
+      cops.push_back (co.fetch_cache_session ());
+    }
+
+    if (co.fetch_jobs_specified ())
+    {
+      cops.push_back ("--fetch-jobs");
+      cops.push_back (to_string (co.fetch_jobs ()));
+    }
+
+    if (co.refresh_cluster ())
+      cops.push_back ("--refresh-cluster");
+
+    if (co.fetch_max_age_specified ())
+    {
+      cops.push_back ("--fetch-max-age");
+      cops.push_back (
+        to_string (std::chrono::duration_cast<std::chrono::seconds> (
+                     co.fetch_max_age ()).count ()));
+    }
+
+    cops.push_back ("--lock-wait");
+    cops.push_back (
+      co.lock_wait_specified ()
+      ? to_string (std::chrono::duration_cast<std::chrono::seconds> (
+                     co.lock_wait ()).count ())
+      : "60");
+
+    if (co.sqlite_synchronous_specified ())
+    {
+      cops.push_back ("--sqlite-synchronous");
+      cops.push_back (to_string (co.sqlite_synchronous ()));
+    }
+
+    if (co.config_index_specified ())
+    {
+      cops.push_back ("--config-index");
+      cops.push_back (co.config_index ().string ());
+    }
+
+    string sv (synced_configs);
+    if (synced_cfgs)
+      sv += '=' + *synced_cfgs; // Unset otherwise.
+
+    string jv (sync_job_var); jv += "=1";
+
+    const char* const envvars[] = {sv.c_str (), jv.c_str (), nullptr};
+
+    // The synchronization result for each cluster, absent if not started.
+    //
+    vector<optional<bool>> rs (n);
+
+    auto summary = [n, &clusters, &rs] ()
+    {
+      if (verb)
       {
-        linked_config c;
+        size_t s (count (rs.begin (), rs.end (), optional<bool> (true)));
 
-        optional<pair<bool /* path */, bool /* uuid */>> s;
-        while (!eof (getline (is, l)))
+        diag_record dr (text);
+        dr << "synchronized " << s << " of " << n << " configuration clusters";
+
+        for (size_t i (0); i != n; ++i)
         {
-          if (!s)
-            s = make_pair (false, false);
+          if (!rs[i] || !*rs[i])
+            dr << info << (rs[i] ? "failed to synchronize" : "skipped")
+               << " cluster of configuration " << clusters[i].front ();
+        }
+      }
+    };
 
-          if (l.empty ())
-            break;
+    try
+    {
+      run_concurrently (
+        sync_jobs (co),
+        n,
+        intro,
+        [&prj, &clusters, &ops, &pp, &cops, &envvars] (size_t i,
+                                                       int out,
+                                                       int err)
+        {
+          strings args (cops);
+          args.insert (args.end (), ops.begin (), ops.end ());
 
-          if (l.compare (0, 6, "path: ") == 0)
+          if (!prj.empty ())
           {
-            try
-            {
-              c.path = dir_path (string (l, 6));
-              s->first = true;
-            }
-            catch (const invalid_path&)
-            {
-              fail << "invalid bpkg-cfg-info output line '" << l
-                   << "': invalid configuration path";
-            }
+            args.push_back ("-d");
+            args.push_back (prj.string ());
           }
-          else if (l.compare (0, 6, "uuid: ") == 0)
+
+          for (const sync_config& c: clusters[i])
           {
-            try
-            {
-              c.uuid = uuid (string (l, 6));
-              s->second = true;
-            }
-            catch (const invalid_argument&)
-            {
-              fail << "invalid bpkg-cfg-info output line '" << l
-                   << "': invalid configuration uuid";
-            }
+            args.push_back ("--config");
+            args.push_back (c.path ().string ());
           }
-        }
 
-        if (s)
-        {
-          if (!s->first)
-            fail << "invalid bpkg-cfg-info output: missing configuration path";
-
-          if (!s->second)
-            fail << "invalid bpkg-cfg-info output: missing configuration uuid";
+          // Don't let the concurrent processes read our stdin (note that the
+          // output is buffered and so any prompts won't be seen anyway).
+          //
+          int in (0);
+          auto_fd null;
 
-          r.push_back (move (c));
-        }
-      }
-      while (!is.eof ());
+          if (out != 1)
+            in = (null = open_null ()).get ();
 
-      is.close (); // Detect errors.
+          try
+          {
+            return butl::process_start_callback (
+              [] (const char* const args[], size_t n)
+              {
+                if (verb >= 2)
+                  print_process (args, n);
+              },
+              in,
+              out,
+              err,
+              process_env (pp, envvars),
+              "sync",
+              args);
+          }
+          catch (const process_error& e)
+          {
+            fail << "unable to execute " << pp.recall_string () << ": " << e
+                 << endf;
+          }
+        },
+        [&pp, &rs] (size_t i, process& pr)
+        {
+          rs[i] = false;
+          finish (pp.recall_string (), pr);
+          rs[i] = true;
+        });
     }
-    catch (const io_error&)
+    catch (const failed&)
     {
-      // Presumably the child process failed and issued diagnostics so let
-      // finish_bpkg() try to deal with that first.
-      //
-      io = true;
+      summary ();
+      throw;
     }
 
-    finish_bpkg (co, pr, io);
-
-    if (r.empty ()) // We should have at least the main configuration.
-      fail << "invalid bpkg-cfg-info output: missing configuration information";
-
-    return r;
+    summary ();
   }
 
   synced_configs_guard
@@ -2283,6 +3383,8 @@ namespace bdep
             transaction* t,
             vector<pair<dir_path, string>>* created_cfgs)
   {
+    tracer trace ("cmd_sync");
+
     assert (!c->packages.empty ());
 
     synced_configs_guard r (getenv (synced_configs));
@@ -2293,7 +3395,26 @@ namespace bdep
       return r;
     }
 
-    linked_configs lcfgs (find_config_cluster (co, c->path));
+    // Skip the implicit sync if nothing has changed since the last one (see
+    // sync_fingerprint() for details), marking the rest of the cluster as
+    // synchronized.
+    //
+    if (implicit                 &&
+        pkg_args.empty ()        &&
+        prj_pkgs.empty ()        &&
+        !(fetch && *fetch)       &&
+        sync_fingerprint_match (co, prj, *c, t, trace))
+    {
+      for (const dir_path& d: c->sync_cluster)
+      {
+        if (d != c->path)
+          synced (d, true /* implicit */);
+      }
+
+      return r;
+    }
+
+    linked_configs lcfgs (find_config_cluster (co, prj, *c, t, trace));
     for (auto j (lcfgs.begin () + 1); j != lcfgs.end (); ++j)
     {
       bool r (synced (j->path, true /* implicit */));
@@ -2339,10 +3460,53 @@ namespace bdep
             bool create_host_config,
             bool create_build2_config)
   {
+    tracer trace ("cmd_sync");
+
     // Similar approach to the args overload below.
     //
     list<sync_config> cfgs (xcfgs.begin (), xcfgs.end ());
 
+    auto sync = [&co, &prj, implicit, &pkg_args, fetch, yes, name_cfg,
+                 &prj_pkgs, &so, create_host_config, create_build2_config]
+                (sync_configs&& ocfgs, linked_configs&& lcfgs)
+    {
+      cmd_sync (co,
+                prj,
+                move (ocfgs),
+                move (lcfgs),
+                pkg_args,
+                implicit,
+                fetch ? false /* shallow */ : optional<bool> (),
+                3                    /* bpkg_fetch_verb */,
+                yes,
+                name_cfg,
+                nullopt              /* upgrade         */,
+                nullopt              /* recursive       */,
+                false                /* disfigure       */,
+                prj_pkgs,
+                strings ()           /* dep_pkgs        */,
+                strings ()           /* deinit_pkgs     */,
+                so,
+                create_host_config,
+                create_build2_config,
+                nullptr,
+                nullptr);
+    };
+
+    // Collect the clusters and synchronize them concurrently if requested
+    // and the sync can be expressed on the bdep-sync command line (see
+    // sync_clusters() for details).
+    //
+    bool concurrent (sync_jobs (co) > 1 &&
+                     cfgs.size () > 1   &&
+                     pkg_args.empty ()  &&
+                     prj_pkgs.empty ()  &&
+                     fetch              &&
+                     yes);
+
+    optional<string> synced_cfgs (getenv (synced_configs));
+    vector<pair<sync_configs, linked_configs>> clusters;
+
     while (!cfgs.empty ())
     {
       sync_configs ocfgs; // Originating configurations for this sync.
@@ -2357,7 +3521,46 @@ namespace bdep
       if (synced (cd, implicit))
         continue;
 
-      linked_configs lcfgs (find_config_cluster (co, cd));
+      // Skip the implicit sync if nothing has changed since the last one
+      // for this configuration as well as for the rest of the specified
+      // configurations from its cluster (see sync_fingerprint() for
+      // details).
+      //
+      if (implicit && pkg_args.empty () && prj_pkgs.empty ())
+      {
+        configuration& c (*ocfgs.back ());
+
+        bool m (sync_fingerprint_match (co, prj, c, nullptr, trace));
+
+        for (auto i (cfgs.begin ()); m && i != cfgs.end (); ++i)
+        {
+          if (find (c.sync_cluster.begin (),
+                    c.sync_cluster.end (),
+                    i->path ()) != c.sync_cluster.end ())
+            m = sync_fingerprint_match (co, prj, **i, nullptr, trace);
+        }
+
+        if (m)
+        {
+          for (const dir_path& d: c.sync_cluster)
+          {
+            if (d != cd)
+              synced (d, true /* implicit */);
+          }
+
+          cfgs.remove_if ([&c] (const sync_config& sc)
+                          {
+                            return find (c.sync_cluster.begin (),
+                                         c.sync_cluster.end (),
+                                         sc.path ()) !=
+                                   c.sync_cluster.end ();
+                          });
+          continue;
+        }
+      }
+
+      linked_configs lcfgs (
+        find_config_cluster (co, prj, *ocfgs.back (), nullptr, trace));
 
       for (auto j (lcfgs.begin () + 1); j != lcfgs.end (); ++j)
       {
@@ -2380,27 +3583,29 @@ namespace bdep
         }
       }
 
-      cmd_sync (co,
-                prj,
-                move (ocfgs),
-                move (lcfgs),
-                pkg_args,
-                implicit,
-                fetch ? false /* shallow */ : optional<bool> (),
-                3                    /* bpkg_fetch_verb */,
-                yes,
-                name_cfg,
-                nullopt              /* upgrade         */,
-                nullopt              /* recursive       */,
-                false                /* disfigure       */,
-                prj_pkgs,
-                strings ()           /* dep_pkgs        */,
-                strings ()           /* deinit_pkgs     */,
-                so,
-                create_host_config,
-                create_build2_config,
-                nullptr,
-                nullptr);
+      if (concurrent)
+        clusters.emplace_back (move (ocfgs), move (lcfgs));
+      else
+        sync (move (ocfgs), move (lcfgs));
+    }
+
+    if (clusters.size () == 1)
+    {
+      sync (move (clusters[0].first), move (clusters[0].second));
+    }
+    else if (!clusters.empty ())
+    {
+      strings ops (sys_ops (so));
+
+      if (implicit)             ops.push_back ("--implicit");
+      if (create_host_config)   ops.push_back ("--create-host-config");
+      if (create_build2_config) ops.push_back ("--create-build2-config");
+
+      vector<sync_configs> cs;
+      for (auto& c: clusters)
+        cs.push_back (move (c.first));
+
+      sync_clusters (co, prj, cs, synced_cfgs, ops, nullptr /* intro */);
     }
   }
 
@@ -2452,19 +3657,52 @@ namespace bdep
     return r;
   }
 
-  void
-  cmd_sync_implicit (const common_options& co,
-                     const dir_paths& xcfgs,
-                     bool fetch,
-                     bool yes,
-                     bool name_cfg,
-                     const sys_options& so,
-                     bool create_host_config,
-                     bool create_build2_config)
-  {
-    // Similar approach to the args overload below.
+  void
+  cmd_sync_implicit (const common_options& co,
+                     const dir_paths& xcfgs,
+                     bool fetch,
+                     bool yes,
+                     bool name_cfg,
+                     const sys_options& so,
+                     bool create_host_config,
+                     bool create_build2_config)
+  {
+    // Similar approach to the args overload below.
+    //
+    list<sync_config> cfgs (xcfgs.begin (), xcfgs.end ());
+
+    auto sync = [&co, fetch, yes, name_cfg,
+                 &so, create_host_config, create_build2_config]
+                (sync_configs&& ocfgs, linked_configs&& lcfgs)
+    {
+      cmd_sync (co,
+                dir_path ()           /* prj             */,
+                move (ocfgs),
+                move (lcfgs),
+                strings ()            /* pkg_args        */,
+                true                  /* implicit        */,
+                fetch ? false /* shallow */ : optional<bool> (),
+                3,                    /* bpkg_fetch_verb */
+                yes,
+                name_cfg,
+                nullopt               /* upgrade         */,
+                nullopt               /* recursive       */,
+                false                 /* disfigure       */,
+                package_locations ()  /* prj_pkgs        */,
+                strings ()            /* dep_pkgs        */,
+                strings ()            /* deinit_pkgs     */,
+                so,
+                create_host_config,
+                create_build2_config);
+    };
+
+    // Collect the clusters and synchronize them concurrently if requested
+    // (see the project overload above for details).
     //
-    list<sync_config> cfgs (xcfgs.begin (), xcfgs.end ());
+    bool concurrent (sync_jobs (co) > 1 && cfgs.size () > 1 && fetch && yes);
+
+    optional<string> synced_cfgs (getenv (synced_configs));
+    vector<pair<sync_configs, linked_configs>> clusters;
 
     while (!cfgs.empty ())
     {
@@ -2499,25 +3737,35 @@ namespace bdep
         }
       }
 
-      cmd_sync (co,
-                dir_path ()           /* prj             */,
-                move (ocfgs),
-                move (lcfgs),
-                strings ()            /* pkg_args        */,
-                true                  /* implicit        */,
-                fetch ? false /* shallow */ : optional<bool> (),
-                3,                    /* bpkg_fetch_verb */
-                yes,
-                name_cfg,
-                nullopt               /* upgrade         */,
-                nullopt               /* recursive       */,
-                false                 /* disfigure       */,
-                package_locations ()  /* prj_pkgs        */,
-                strings ()            /* dep_pkgs        */,
-                strings ()            /* deinit_pkgs     */,
-                so,
-                create_host_config,
-                create_build2_config);
+      if (concurrent)
+        clusters.emplace_back (move (ocfgs), move (lcfgs));
+      else
+        sync (move (ocfgs), move (lcfgs));
+    }
+
+    if (clusters.size () == 1)
+    {
+      sync (move (clusters[0].first), move (clusters[0].second));
+    }
+    else if (!clusters.empty ())
+    {
+      strings ops (sys_ops (so));
+
+      ops.push_back ("--implicit");
+
+      if (create_host_config)   ops.push_back ("--create-host-config");
+      if (create_build2_config) ops.push_back ("--create-build2-config");
+
+      vector<sync_configs> cs;
+      for (auto& c: clusters)
+        cs.push_back (move (c.first));
+
+      sync_clusters (co,
+                     dir_path () /* prj */,
+                     cs,
+                     synced_cfgs,
+                     ops,
+                     nullptr     /* intro */);
     }
   }
 
@@ -2529,8 +3777,11 @@ namespace bdep
                    transaction* origin_tr,
                    vector<pair<dir_path, string>>* created_cfgs)
   {
+    tracer trace ("cmd_sync_deinit");
+
     sync_configs ocfgs {cfg};
-    linked_configs lcfgs (find_config_cluster (co, cfg->path));
+    linked_configs lcfgs (
+      find_config_cluster (co, prj, *cfg, origin_tr, trace));
 
     cmd_sync (co,
               prj,
@@ -2583,7 +3834,7 @@ namespace bdep
     //
     if (o.hook_specified ())
     {
-      if (o.hook () != 1)
+      if (o.hook () != 1 && o.hook () != 2)
         fail << "unsupported build system hook protocol" <<
           info << "project requires re-initialization";
 
@@ -2861,6 +4112,12 @@ namespace bdep
         if (synced (d, o.implicit (), false /* add */))
           continue;
 
+        // Skip the configuration if nothing has changed since the last sync
+        // according to the stamp in its hook.
+        //
+        if (o.hook () == 2 && hook_stamp_match (d))
+          continue;
+
         cfgs.push_back (move (d));
       }
 
@@ -2883,77 +4140,34 @@ namespace bdep
     // So what we are going to do is remove configurations from cfgs/cfg_dirs
     // as we go along.
     //
-    bool empty (true); // All configurations are empty.
-    for (size_t i (0), n (cfgs.size ()); !cfgs.empty (); )
-    {
-      sync_configs ocfgs; // Originating configurations for this sync.
-      optional<size_t> m; // Number of packages in ocfgs.
-
-      ocfgs.push_back (move (cfgs.front ()));
-      cfgs.pop_front ();
-
-      if (const shared_ptr<configuration>& c = ocfgs.back ())
-        m = c->packages.size ();
-
-      const dir_path& cd (ocfgs.back ().path ());
-
-      // Check if this configuration is already (being) synchronized.
-      //
-      // Note that we should ignore the whole cluster but we can't run bpkg
-      // here. So we will just ignore the configurations one by one (we expect
-      // them all to be on the list, see below).
-      //
-      if (synced (cd, o.implicit ()))
-      {
-        empty = false;
-        continue;
-      }
-
-      // Get the linked configuration cluster and "pull out" of cfgs
-      // configurations that belong to this cluster. While at it also mark the
-      // entire cluster as being synced.
-      //
-      // Note: we have already dealt with the first configuration in lcfgs.
-      //
-      linked_configs lcfgs (find_config_cluster (o, cd));
-
-      for (auto j (lcfgs.begin () + 1); j != lcfgs.end (); ++j)
-      {
-        const linked_config& cfg (*j);
-
-        bool r (synced (cfg.path, true /* implicit */));
-        assert (!r); // Should have been skipped via the first above.
-
-        for (auto i (cfgs.begin ()); i != cfgs.end (); )
-        {
-          if (cfg.path == i->path ())
-          {
-            ocfgs.push_back (move (*i));
-            i = cfgs.erase (i);
-
-            if (const shared_ptr<configuration>& c = ocfgs.back ())
-              *m += c->packages.size ();
-          }
-          else
-            ++i;
-        }
-      }
-
-      // Skipping empty ones (part one).
-      //
-      // Note that we would normally be printing that for build-time
-      // dependency configurations (which normally will not have any
-      // initialized packages) and that would be annoying. So we suppress it
-      // in case of the default configuration fallback (but also check and
-      // warn if all of them were empty below).
-      //
-      if (m && *m == 0 && default_fallback)
-        continue;
+    // If requested, we first collect the clusters and then synchronize them
+    // concurrently (see sync_clusters() for details). We, however, only do
+    // this for the first form without any additional arguments (including
+    // packages implied by the current working directory), which can be
+    // easily expressed on the bdep-sync command line.
+    //
+    bool concurrent (sync_jobs (o) > 1  &&
+                     cfgs.size () > 1   &&
+                     pkg_args.empty ()  &&
+                     prj_pkgs.empty ()  &&
+                     dep_pkgs.empty ()  &&
+                     !o.upgrade ()      &&
+                     !o.patch ());
+
+    optional<string> synced_cfgs (getenv (synced_configs));
+    vector<pair<sync_configs, linked_configs>> clusters;
+
+    // If we are synchronizing multiple configurations, separate them with a
+    // blank line and print the configuration name/directory.
+    //
+    // Note that if we are a concurrent synchronization job, then this is
+    // done by our parent.
+    //
+    size_t i (0), n (cfgs.size ());
 
-      // If we are synchronizing multiple configurations, separate them with a
-      // blank line and print the configuration name/directory.
-      //
-      if (verb && n > 1)
+    auto print_header = [&i, n] (const sync_configs& ocfgs)
+    {
+      if (verb && n > 1 && !sync_job)
       {
         diag_record dr (text);
 
@@ -2970,31 +4184,11 @@ namespace bdep
 
         dr << ':';
       }
+    };
 
-      // Skipping empty ones (part two).
-      //
-      if (m && *m == 0)
-      {
-        if (verb)
-        {
-          diag_record dr (info);
-          dr << "no packages initialized in ";
-
-          // Note that in case of a cluster, we know we have printed the
-          // configurations (see above) and thus can omit mentioning them
-          // here.
-          //
-          if (ocfgs.size () == 0)
-            dr << "configuration " << *ocfgs.back () << ", skipping";
-          else
-            dr << "configuration cluster, skipping";
-        }
-
-        continue;
-      }
-
-      empty = false;
-
+    auto sync = [&o, &prj, &prj_pkgs, &pkg_args, &dep_pkgs]
+                (sync_configs&& ocfgs, linked_configs&& lcfgs)
+    {
       bool fetch (o.fetch () || o.fetch_full ());
 
       if (fetch)
@@ -3101,6 +4295,142 @@ namespace bdep
                   o.create_host_config (),
                   o.create_build2_config ());
       }
+    };
+
+    bool empty (true); // All configurations are empty.
+    while (!cfgs.empty ())
+    {
+      sync_configs ocfgs; // Originating configurations for this sync.
+      optional<size_t> m; // Number of packages in ocfgs.
+
+      ocfgs.push_back (move (cfgs.front ()));
+      cfgs.pop_front ();
+
+      if (const shared_ptr<configuration>& c = ocfgs.back ())
+        m = c->packages.size ();
+
+      const dir_path& cd (ocfgs.back ().path ());
+
+      // Check if this configuration is already (being) synchronized.
+      //
+      // Note that we should ignore the whole cluster but we can't run bpkg
+      // here. So we will just ignore the configurations one by one (we expect
+      // them all to be on the list, see below).
+      //
+      if (synced (cd, o.implicit ()))
+      {
+        empty = false;
+        continue;
+      }
+
+      // Get the linked configuration cluster and "pull out" of cfgs
+      // configurations that belong to this cluster. While at it also mark the
+      // entire cluster as being synced.
+      //
+      // Note: we have already dealt with the first configuration in lcfgs.
+      //
+      linked_configs lcfgs (
+        ocfgs.back () != nullptr
+        ? find_config_cluster (o, prj, *ocfgs.back (), nullptr, trace)
+        : find_config_cluster (o, cd));
+
+      for (auto j (lcfgs.begin () + 1); j != lcfgs.end (); ++j)
+      {
+        const linked_config& cfg (*j);
+
+        bool r (synced (cfg.path, true /* implicit */));
+        assert (!r); // Should have been skipped via the first above.
+
+        for (auto i (cfgs.begin ()); i != cfgs.end (); )
+        {
+          if (cfg.path == i->path ())
+          {
+            ocfgs.push_back (move (*i));
+            i = cfgs.erase (i);
+
+            if (const shared_ptr<configuration>& c = ocfgs.back ())
+              *m += c->packages.size ();
+          }
+          else
+            ++i;
+        }
+      }
+
+      // Skipping empty ones (part one).
+      //
+      // Note that we would normally be printing that for build-time
+      // dependency configurations (which normally will not have any
+      // initialized packages) and that would be annoying. So we suppress it
+      // in case of the default configuration fallback (but also check and
+      // warn if all of them were empty below).
+      //
+      if (m && *m == 0 && default_fallback)
+        continue;
+
+      // Skipping empty ones (part two).
+      //
+      if (m && *m == 0)
+      {
+        print_header (ocfgs);
+
+        if (verb)
+        {
+          diag_record dr (info);
+          dr << "no packages initialized in ";
+
+          // Note that in case of a cluster, we know we have printed the
+          // configurations (see above) and thus can omit mentioning them
+          // here.
+          //
+          if (ocfgs.size () == 0)
+            dr << "configuration " << *ocfgs.back () << ", skipping";
+          else
+            dr << "configuration cluster, skipping";
+        }
+
+        continue;
+      }
+
+      empty = false;
+
+      if (concurrent)
+        clusters.emplace_back (move (ocfgs), move (lcfgs));
+      else
+      {
+        print_header (ocfgs);
+        sync (move (ocfgs), move (lcfgs));
+      }
+    }
+
+    if (clusters.size () == 1)
+    {
+      print_header (clusters[0].first);
+      sync (move (clusters[0].first), move (clusters[0].second));
+    }
+    else if (!clusters.empty ())
+    {
+      strings ops (sys_ops (sys_options (o)));
+
+      if (o.implicit ())             ops.push_back ("--implicit");
+      if (o.fetch ())                ops.push_back ("--fetch");
+      if (o.fetch_full ())           ops.push_back ("--fetch-full");
+      if (o.disfigure ())            ops.push_back ("--disfigure");
+      if (o.create_host_config ())   ops.push_back ("--create-host-config");
+      if (o.create_build2_config ()) ops.push_back ("--create-build2-config");
+
+      vector<sync_configs> cs;
+      for (auto& c: clusters)
+        cs.push_back (move (c.first));
+
+      sync_clusters (o,
+                     prj,
+                     cs,
+                     synced_cfgs,
+                     ops,
+                     [&cs, &print_header] (size_t i)
+                     {
+                       print_header (cs[i]);
+                     });
     }
 
     if (empty && default_fallback)
@@ -3112,6 +4442,35 @@ namespace bdep
     return 0;
   }
 
+  void
+  run_b_forward (const common_options& co,
+                 const char* mo,
+                 const vector<pair<dir_path, dir_path>>& fs)
+  {
+    if (fs.empty ())
+      return;
+
+    string bspec (mo);
+    bspec += '(';
+
+    for (const pair<dir_path, dir_path>& f: fs)
+    {
+      if (bspec.back () != '(')
+        bspec += ' ';
+
+      bspec += '\'' + f.first.representation () + "'@'" +
+               f.second.representation () + '\'';
+    }
+
+    bspec += ",forward)";
+
+    // Note that --no-external-modules makes a difference for developing
+    // build system modules that require bootstrapping (which without that
+    // option would trigger a recursive sync).
+    //
+    run_b (co, "--no-external-modules", bspec);
+  }
+
   default_options_files
   options_files (const char*, const cmd_sync_options& o, const strings&)
   {
@@ -103,7 +103,8 @@ namespace bdep
             vector<pair<dir_path, string>>* created_cfgs = nullptr);
 
   // As above but sync multiple configurations. If some configurations belong
-  // to the same cluster, then they are synced at once.
+  // to the same cluster, then they are synced at once. Independent clusters
+  // can be synced concurrently (see --sync-jobs for details).
   //
   // Note: in the rest of cmd_sync() overloads, fetch is bool, with false
   // meaning do not fetch and true -- fetch shallow.
@@ -173,13 +174,41 @@ namespace bdep
   cmd_sync (cmd_sync_options&&, cli::group_scanner& args);
 
   // Return the list of additional (to prj, if not empty) projects that are
-  // using this configuration.
+  // using this configuration (see config-index.hxx for details).
   //
   dir_paths
   configuration_projects (const common_options& co,
                           const dir_path& cfg,
                           const dir_path& prj = dir_path ());
 
+  // Calculate the checksum of the specified strings and of the modification
+  // times of the specified filesystem entries.
+  //
+  string
+  sync_checksum (const strings&, const paths&);
+
+  // Return the checksum of the modification times of the specified bpkg
+  // configurations' databases. Can be used to detect the configurations
+  // changes without running bpkg.
+  //
+  string
+  bpkg_stamp (const dir_paths& cfgs);
+
+  // Return the list of dir repository directories of this configuration
+  // (as reported by bpkg-rep-list).
+  //
+  dir_paths
+  configuration_repositories (const common_options& co, const dir_path& cfg);
+
+  // Configure or disfigure (depending on the meta-operation) forwarding for
+  // the specified src/out directory pairs with a single build system
+  // invocation. Do nothing if the list is empty.
+  //
+  void
+  run_b_forward (const common_options&,
+                 const char* meta_operation,
+                 const vector<pair<dir_path, dir_path>>&);
+
   default_options_files
   options_files (const char* cmd,
                  const cmd_sync_options&,
@@ -12,23 +12,26 @@
 
 namespace bdep
 {
-  inline void
+  inline process
   cmd_test (const cmd_test_options& o,
             const shared_ptr<configuration>& c,
             const cstrings& pkgs,
-            const strings& cfg_vars)
+            const strings& cfg_vars,
+            const strings& jobs,
+            int out,
+            int err)
   {
-    run_bpkg (2,
-              o,
-              "test",
-              "-d", c->path,
-              (o.immediate () ? "--immediate" :
-               o.recursive () ? "--recursive" : nullptr),
-              (o.jobs_specified ()
-               ? strings ({"-j", to_string (o.jobs ())})
-               : strings ()),
-              cfg_vars,
-              pkgs);
+    return start_bpkg (2,
+                       o,
+                       out,
+                       err,
+                       "test",
+                       "-d", c->path,
+                       (o.immediate () ? "--immediate" :
+                        o.recursive () ? "--recursive" : nullptr),
+                       jobs,
+                       cfg_vars,
+                       pkgs);
   }
 
   inline int
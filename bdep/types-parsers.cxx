@@ -103,5 +103,58 @@ namespace bdep
 
       xs = true;
     }
+
+    void parser<duration>::
+    parse (duration& r, bool& xs, scanner& s)
+    {
+      using std::chrono::seconds;
+
+      const char* o (s.next ());
+
+      if (!s.more ())
+        throw missing_value (o);
+
+      string v (s.next ());
+
+      // Note that we don't allow signs, whitespaces, etc.
+      //
+      size_t n (v.find_first_not_of ("0123456789"));
+
+      if (n == 0 || (n != string::npos && n + 1 != v.size ()))
+        throw invalid_value (o, v);
+
+      uint64_t m;
+      switch (n != string::npos ? v[n] : 's')
+      {
+      case 's': m = 1;     break;
+      case 'm': m = 60;    break;
+      case 'h': m = 3600;  break;
+      case 'd': m = 86400; break;
+      default:  throw invalid_value (o, v);
+      }
+
+      uint64_t c;
+      try
+      {
+        c = std::stoull (string (v, 0, n));
+      }
+      catch (const std::exception&) // Out of range.
+      {
+        throw invalid_value (o, v);
+      }
+
+      // Make sure the number of seconds is representable as duration.
+      //
+      const uint64_t mx (
+        std::chrono::duration_cast<seconds> (duration::max ()).count ());
+
+      if (c > mx / m)
+        throw invalid_value (o, v);
+
+      r = std::chrono::duration_cast<duration> (
+        seconds (static_cast<seconds::rep> (c * m)));
+
+      xs = true;
+    }
   }
 }
@@ -68,6 +68,20 @@ namespace bdep
       static void
       merge (sqlite_synchronous& b, const sqlite_synchronous& a) {b = a;}
     };
+
+    // Parse a duration specified as an integer number followed by an
+    // optional unit suffix: s (seconds, default), m (minutes), h (hours), or
+    // d (days).
+    //
+    template <>
+    struct parser<duration>
+    {
+      static void
+      parse (duration&, bool&, scanner&);
+
+      static void
+      merge (duration& b, const duration& a) {b = a;}
+    };
   }
 }
 
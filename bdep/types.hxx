@@ -27,6 +27,7 @@
 #include <libbutl/uuid-io.hxx>
 #include <libbutl/process.hxx>
 #include <libbutl/optional.hxx>
+#include <libbutl/timestamp.hxx>
 #include <libbutl/fdstream.hxx>
 #include <libbutl/small-vector.hxx>
 #include <libbutl/default-options.hxx>
@@ -87,6 +88,12 @@ namespace bdep
   //
   using butl::url;
 
+  // <libbutl/timestamp.hxx>
+  //
+  using butl::duration;
+  using butl::timestamp;
+  using butl::timestamp_nonexistent;
+
   // <libbutl/path.hxx>
   //
   using butl::path;
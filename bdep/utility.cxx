@@ -3,6 +3,10 @@
 
 #include <bdep/utility.hxx>
 
+#include <deque>
+#include <thread>   // thread::hardware_concurrency()
+#include <iostream> // cout
+
 #include <libbutl/process.hxx>
 #include <libbutl/fdstream.hxx>
 
@@ -20,6 +24,7 @@ namespace bdep
   const dir_path bdep_dir  (".bdep");
   const path     bdep_file (bdep_dir / "bdep.sqlite3");
   const dir_path bpkg_dir  (".bpkg");
+  const path     bpkg_file (bpkg_dir / "bpkg.sqlite3");
 
   const path manifest_file       ("manifest");
   const path packages_file       ("packages.manifest");
@@ -29,6 +34,8 @@ namespace bdep
   const char* argv0;
   dir_path exec_dir;
 
+  bool sync_job;
+
   dir_path temp_dir;
 
   auto_rmfile
@@ -53,8 +60,13 @@ namespace bdep
     // directory, we simply create tmp in a system one and let the command
     // complain if necessary.
     //
-    dir_path d (prj.empty () ||
-                !exists (prj / bdep_dir, true /* ignore_error */)
+    // We also use a system one if we are a concurrent synchronization job
+    // not to clean up the project's tmp that is used by our parent and
+    // siblings (see sync_clusters() in sync.cxx for details).
+    //
+    dir_path d (prj.empty ()                                     ||
+                !exists (prj / bdep_dir, true /* ignore_error */) ||
+                sync_job
                 ? dir_path::temp_path ("bdep")
                 : prj / bdep_dir / dir_path ("tmp"));
 
@@ -264,6 +276,123 @@ namespace bdep
     }
   }
 
+  void
+  run_concurrently (size_t jobs,
+                    size_t n,
+                    const function<void (size_t)>& intro,
+                    const function<process (size_t, int, int)>& start,
+                    const function<void (size_t, process&)>& finish)
+  {
+    if (jobs <= 1 || n <= 1)
+    {
+      for (size_t i (0); i != n; ++i)
+      {
+        if (intro)
+          intro (i);
+
+        process pr (start (i, 1 /* stdout */, 2 /* stderr */));
+        finish (i, pr);
+      }
+
+      return;
+    }
+
+    struct job
+    {
+      size_t      index;
+      process     pr;
+      auto_rmfile out;
+      auto_rmfile err;
+    };
+
+    auto open = [] (const path& f)
+    {
+      try
+      {
+        return fdopen (f,
+                       fdopen_mode::out    |
+                       fdopen_mode::create |
+                       fdopen_mode::truncate);
+      }
+      catch (const io_error& e)
+      {
+        fail << "unable to open " << f << ": " << e << endf;
+      }
+    };
+
+    auto read = [] (const path& f)
+    {
+      try
+      {
+        ifdstream is (f, ifdstream::badbit);
+        return is.read_text ();
+      }
+      catch (const io_error& e)
+      {
+        fail << "unable to read " << f << ": " << e << endf;
+      }
+    };
+
+    // Note that we wait for the commands in the order they were started
+    // which naturally gives us the ordered output.
+    //
+    deque<job> running;
+    bool failure (false);
+
+    for (size_t next (0); next != n || !running.empty (); )
+    {
+      for (; !failure && next != n && running.size () != jobs; ++next)
+      {
+        auto_rmfile of (tmp_file ("out"));
+        auto_rmfile ef (tmp_file ("err"));
+
+        process pr;
+        {
+          auto_fd ofd (open (of.path));
+          auto_fd efd (open (ef.path));
+
+          pr = start (next, ofd.get (), efd.get ());
+        }
+
+        running.push_back (job {next, move (pr), move (of), move (ef)});
+      }
+
+      if (running.empty ())
+        break;
+
+      job& j (running.front ());
+
+      j.pr.wait ();
+
+      if (intro)
+        intro (j.index);
+
+      cout << read (j.out.path) << flush;
+      *diag_stream << read (j.err.path) << flush;
+
+      try
+      {
+        finish (j.index, j.pr);
+      }
+      catch (const failed&)
+      {
+        failure = true;
+      }
+
+      running.pop_front ();
+    }
+
+    if (failure)
+      throw failed ();
+  }
+
+  size_t
+  hardware_concurrency ()
+  {
+    size_t r (thread::hardware_concurrency ());
+    return r != 0 ? r : 1;
+  }
+
   string bpkg_fetch_cache_session;
 
   const char*
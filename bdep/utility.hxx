@@ -74,6 +74,8 @@ namespace bdep
   using butl::auto_rmfile;
   using butl::auto_rmdir;
 
+  using butl::file_mtime;
+
   // <libbutl/default-options.hxx>
   //
   using butl::load_default_options;
@@ -91,6 +93,7 @@ namespace bdep
   extern const dir_path bdep_dir;  // .bdep/
   extern const path     bdep_file; // .bdep/bdep.sqlite3
   extern const dir_path bpkg_dir;  // .bpkg/
+  extern const path     bpkg_file; // .bpkg/bpkg.sqlite3
 
   extern const path manifest_file;       // manifest
   extern const path packages_file;       // packages.manifest
@@ -128,6 +131,13 @@ namespace bdep
   //
   extern dir_path exec_dir;
 
+  // True if we are a concurrent synchronization job (see sync_clusters() in
+  // sync.cxx for details). Note that main() unsets the BDEP_SYNC_JOB
+  // environment variable this is determined from so that it doesn't
+  // propagate to the nested invocations (for example, via the hook).
+  //
+  extern bool sync_job;
+
   // Path.
   //
   dir_path
@@ -277,6 +287,34 @@ namespace bdep
   void
   run_b (const common_options&, A&&... args);
 
+  // Run commands concurrently.
+  //
+  // Start n commands by calling the start function with the command index
+  // and the stdout and stderr file descriptors to use, keeping at most the
+  // specified number of them running at any given time. The output of each
+  // command is buffered and, once the command completes, printed as a whole
+  // in the order of the commands, preceded by the call to the intro function
+  // (if specified) and followed by the call to the finish function (which is
+  // expected to throw failed if the command has failed, normally by calling
+  // finish_bpkg() or similar). Once a command fails, no further commands are
+  // started and failed is thrown after the running ones complete.
+  //
+  // If jobs is 1 or there is only one command, then the commands are run
+  // serially with their output not buffered.
+  //
+  void
+  run_concurrently (size_t jobs,
+                    size_t n,
+                    const function<void (size_t)>& intro,
+                    const function<process (size_t, int out, int err)>& start,
+                    const function<void (size_t, process&)>& finish);
+
+  // Return the number of available hardware threads or 1 if it cannot be
+  // determined.
+  //
+  size_t
+  hardware_concurrency ();
+
   // Manifest parsing and serialization.
   //
   // For parsing, if path is '-', then read from stdin.